@@ -0,0 +1,282 @@
+//
+//  Batch_solver.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Library include
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+// Class include
+#include "Map.hpp"
+#include "Sokoban_features.hpp"
+
+// Defines
+#define BATCH_DEFAULT_RUNS        5 // runs of every map, as loop_script did
+#define BATCH_DEFAULT_MAX_SEARCH  10000000
+#define BATCH_MAP_SUFFIX          ".txt" // files of a directory that are loaded as maps
+
+// Namespaces
+using namespace std;
+
+class Batch_solver
+// Solves a suite of maps in one process. Every map is loaded and its distance maps are built once; the runs of all maps
+// are then solved by a pool of worker threads, each run with a Sokoban_features of its own that only reads the shared Map.
+// The pool has one thread per core so the wall-clock time of the suite is bounded by the cores and not the number of maps
+{
+public:
+    struct batch_result {
+        int map_id;
+        int run;
+        bool solved = false;
+        int steps = 0;
+        double cost = 0;
+        long closed = 0;
+        long open = 0;
+        long long time_us = 0;
+    };
+
+	// Constructor, overload constructor, and destructor
+    Batch_solver();
+    ~Batch_solver();
+
+	// Public Methods
+    bool add_path(const string& in_path);
+    vector< string > get_map_files();
+    void set_solver(int in_solver_type);
+    void set_runs(int in_runs);
+    void set_threads(int in_threads);
+    void set_max_search(int in_max_search);
+    bool run();
+    void print_results();
+    bool save_results(const string& file_name);
+
+private:
+	// Private variables
+    vector< string > map_files;
+    vector< Map* > maps; // nullptr if the map could not be loaded or is deadlocked from the start
+    vector< batch_result > results; // one per task; task = map_id * runs + run
+    int solver_type = Astar;
+    int runs = BATCH_DEFAULT_RUNS;
+    int threads = 0; // 0 uses one thread per core
+    int max_search = BATCH_DEFAULT_MAX_SEARCH;
+    long long wall_time_us = 0;
+    atomic< size_t > next_task;
+    atomic< size_t > finished_tasks;
+    mutex print_mutex;
+
+	// Private Methods
+    bool prepare_maps();
+    void run_worker();
+    void solve_task(size_t in_task);
+    long long currentTimeUs();
+};
+
+Batch_solver::Batch_solver()
+// Default constructor
+{
+}
+
+Batch_solver::~Batch_solver()
+// Default destructor
+{
+    for (size_t i = 0; i < maps.size(); i++)
+        delete maps[i];
+}
+
+long long Batch_solver::currentTimeUs()
+// Timer function
+{
+    timeval current;
+    gettimeofday(&current, 0);
+    return (long long)current.tv_sec * 1000000L + current.tv_usec;
+}
+
+bool Batch_solver::add_path(const string& in_path)
+// Adds a map file or all map files (BATCH_MAP_SUFFIX) of a directory in name order; returns false if nothing was found
+{
+    struct stat path_stat;
+    if (stat(in_path.c_str(), &path_stat) != 0) {
+        cout << "[BATCH] No such file or directory: " << in_path << endl;
+        return false;
+    }
+    if (!S_ISDIR(path_stat.st_mode)) {
+        map_files.push_back(in_path);
+        return true;
+    }
+    DIR* dir = opendir(in_path.c_str());
+    if (dir == nullptr)
+        return false;
+    string suffix = BATCH_MAP_SUFFIX;
+    vector< string > dir_files;
+    for (dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        string name = entry->d_name;
+        if (name.size() > suffix.size() and name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+            dir_files.push_back(in_path + (in_path.back() == '/' ? "" : "/") + name);
+    }
+    closedir(dir);
+    sort(dir_files.begin(), dir_files.end());
+    map_files.insert(map_files.end(), dir_files.begin(), dir_files.end());
+    return dir_files.size() > 0;
+}
+
+vector< string > Batch_solver::get_map_files()
+// Returns the map files added so far
+{
+    return map_files;
+}
+
+void Batch_solver::set_solver(int in_solver_type)
+// Sets the solver used for every run (defines in common)
+{
+    solver_type = in_solver_type;
+}
+
+void Batch_solver::set_runs(int in_runs)
+// Sets the number of runs of every map
+{
+    runs = max(in_runs, 1);
+}
+
+void Batch_solver::set_threads(int in_threads)
+// Sets the number of worker threads; 0 uses one per core
+{
+    threads = max(in_threads, 0);
+}
+
+void Batch_solver::set_max_search(int in_max_search)
+// Sets the max search counter passed to Sokoban_features::solve
+{
+    max_search = in_max_search;
+}
+
+bool Batch_solver::prepare_maps()
+// Loads every map once and builds its deadlock free map, wavefront maps and push distance maps
+// Done on the calling thread so the maps are complete before any worker reads them; returns false if no map is usable
+{
+    bool any_map = false;
+    for (size_t i = 0; i < map_files.size(); i++) {
+        Map* tmp_map = new Map();
+        if (tmp_map->load_map_from_file(map_files[i]) and tmp_map->create_deadlock_free_map()) {
+            tmp_map->create_wavefront_map();
+            tmp_map->create_push_distance_map();
+            any_map = true;
+        } else {
+            delete tmp_map;
+            tmp_map = nullptr;
+        }
+        maps.push_back(tmp_map);
+    }
+    return any_map;
+}
+
+bool Batch_solver::run()
+// Solves all runs of all maps; returns false if there was nothing to solve
+{
+    if (!prepare_maps())
+        return false;
+    results.assign(map_files.size() * runs, batch_result());
+    for (size_t i = 0; i < results.size(); i++) {
+        results[i].map_id = i / runs;
+        results[i].run = i % runs;
+    }
+    size_t pool_size = threads > 0 ? threads : max((int)thread::hardware_concurrency(), 1);
+    pool_size = min(pool_size, results.size());
+    cout << "[BATCH] Solving " << results.size() << " runs of " << map_files.size() << " maps on " << pool_size << " threads" << endl;
+
+    next_task.store(0);
+    finished_tasks.store(0);
+    long long time_start = currentTimeUs();
+    vector< thread > pool;
+    for (size_t i = 1; i < pool_size; i++)
+        pool.push_back(thread(&Batch_solver::run_worker, this));
+    run_worker(); // the calling thread is a worker as well
+    for (size_t i = 0; i < pool.size(); i++)
+        pool[i].join();
+    wall_time_us = currentTimeUs() - time_start;
+    return true;
+}
+
+void Batch_solver::run_worker()
+// Takes the next task until all tasks are taken
+{
+    for (size_t task = next_task++; task < results.size(); task = next_task++)
+        solve_task(task);
+}
+
+void Batch_solver::solve_task(size_t in_task)
+// Solves one run of a map with a solver of its own; only the result slot of the task is written
+// The deadlock pattern file is neither loaded nor saved, so the runs are independent like those of bench_solver
+{
+    batch_result &result = results[in_task];
+    Map* tmp_map = maps[result.map_id];
+    if (tmp_map != nullptr) {
+        Sokoban_features feature_tree(tmp_map);
+        feature_tree.set_verbose(false);
+        feature_tree.set_thread_count(1); // the pool already uses every core
+        long long time_start = currentTimeUs();
+        result.solved = feature_tree.solve(solver_type, max_search);
+        result.time_us = currentTimeUs() - time_start;
+        if (result.solved) {
+            result.steps = feature_tree.get_goal_node_ptr()->depth;
+            result.cost = feature_tree.get_goal_node_ptr()->cost_to_node;
+        }
+        result.closed = feature_tree.get_closed_list_size();
+        result.open = feature_tree.get_open_list_size();
+    }
+    lock_guard< mutex > print_lock(print_mutex);
+    cout << "[BATCH] " << ++finished_tasks << "/" << results.size() << " " << map_files[result.map_id] << " run " << result.run+1
+         << (result.solved ? " solved in " + to_string(result.time_us) + " us" : " not solved") << endl;
+}
+
+void Batch_solver::print_results()
+// Prints one line per map; the time is the median of the runs and the nodes are those of the first run
+// The map is the last column since its path has no fixed width
+{
+    cout << endl << setw(8) << "solved" << setw(8) << "steps" << setw(10) << "cost"
+         << setw(12) << "closed" << setw(12) << "open" << setw(14) << "median_us" << "  map" << endl;
+    for (size_t i = 0; i < map_files.size(); i++) {
+        int solved = 0;
+        vector< long long > times;
+        for (int j = 0; j < runs; j++) {
+            batch_result &result = results[i * runs + j];
+            solved += result.solved;
+            times.push_back(result.time_us);
+        }
+        sort(times.begin(), times.end());
+        batch_result &first = results[i * runs];
+        cout << setw(8) << to_string(solved) + "/" + to_string(runs)
+             << setw(8) << first.steps << setw(10) << first.cost << setw(12) << first.closed << setw(12) << first.open
+             << setw(14) << times[times.size() / 2] << "  " << map_files[i] << endl;
+    }
+    cout << "[BATCH] Wall-clock time of the suite " << wall_time_us << " us" << endl;
+}
+
+bool Batch_solver::save_results(const string& file_name)
+// Writes every run as one line of a csv file
+{
+    ofstream results_file(file_name);
+    if (!results_file.is_open())
+        return false;
+    results_file << "map,run,solver_type,solved,steps,cost,closed_list,open_list,t_diff\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        batch_result &result = results[i];
+        results_file << map_files[result.map_id] << "," << result.run+1 << "," << solver_type << "," << result.solved << ","
+                     << result.steps << "," << result.cost << "," << result.closed << "," << result.open << "," << result.time_us << "\n";
+    }
+    return results_file.good();
+}
@@ -0,0 +1,161 @@
+//
+//  Bitboard.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Library include
+#include <vector>
+
+// Defines
+#define BITBOARD_WORD_BITS  64
+
+// Namespaces
+using namespace std;
+
+class Bitboard
+// One bit per map cell, bit i is cell index i (see Map::cell_index), packed into 64 bit words.
+// Bits past the last cell are always zero so whole words can be combined without masking.
+{
+public:
+	// Constructor, overload constructor, and destructor
+    Bitboard();
+    Bitboard(int in_bits);
+    ~Bitboard();
+
+	// Public Methods
+    void resize(int in_bits);
+    void set(int in_bit);
+    void reset(int in_bit);
+    bool test(int in_bit);
+    void clear();
+    void assign(Bitboard &source_board);
+    int  lowest();
+    void flood(Bitboard &passable, int row_width);
+
+private:
+	// Private variables
+    vector< unsigned long > words;
+    int bits = 0;
+
+	// Private Methods
+    unsigned long shifted_up(size_t word, int shift);
+    unsigned long shifted_down(size_t word, int shift);
+};
+
+Bitboard::Bitboard()
+// Default constructor; an empty board without bits
+{
+}
+
+Bitboard::Bitboard(int in_bits)
+// Overload constructor; a board of in_bits zero bits
+{
+    resize(in_bits);
+}
+
+Bitboard::~Bitboard()
+// Default destructor
+{
+}
+
+void Bitboard::resize(int in_bits)
+// Sets the number of bits and clears the board
+{
+    bits = in_bits;
+    words.assign((in_bits + BITBOARD_WORD_BITS-1) / BITBOARD_WORD_BITS, 0);
+}
+
+void Bitboard::set(int in_bit)
+// Sets a bit
+{
+    words[in_bit / BITBOARD_WORD_BITS] |= 1UL << (in_bit % BITBOARD_WORD_BITS);
+}
+
+void Bitboard::reset(int in_bit)
+// Clears a bit
+{
+    words[in_bit / BITBOARD_WORD_BITS] &= ~(1UL << (in_bit % BITBOARD_WORD_BITS));
+}
+
+bool Bitboard::test(int in_bit)
+// Returns true if the bit is set
+{
+    return (words[in_bit / BITBOARD_WORD_BITS] >> (in_bit % BITBOARD_WORD_BITS)) & 1UL;
+}
+
+void Bitboard::clear()
+// Clears all bits
+{
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] = 0;
+}
+
+void Bitboard::assign(Bitboard &source_board)
+// Copies the bits of a board of the same size
+{
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] = source_board.words[i];
+}
+
+int Bitboard::lowest()
+// Returns the index of the lowest set bit (the top-left cell) or -1 if no bit is set
+{
+    for (size_t i = 0; i < words.size(); i++)
+        if (words[i])
+            return i * BITBOARD_WORD_BITS + __builtin_ctzl(words[i]);
+    return -1;
+}
+
+unsigned long Bitboard::shifted_up(size_t word, int shift)
+// Returns a word of the board shifted towards higher bit indices; 0 < shift < BITBOARD_WORD_BITS * words
+{
+    size_t word_shift = shift / BITBOARD_WORD_BITS;
+    int bit_shift = shift % BITBOARD_WORD_BITS;
+    if (word < word_shift)
+        return 0;
+    unsigned long tmp_word = words[word - word_shift] << bit_shift;
+    if (bit_shift and word > word_shift)
+        tmp_word |= words[word - word_shift - 1] >> (BITBOARD_WORD_BITS - bit_shift);
+    return tmp_word;
+}
+
+unsigned long Bitboard::shifted_down(size_t word, int shift)
+// Returns a word of the board shifted towards lower bit indices; 0 < shift < BITBOARD_WORD_BITS * words
+{
+    size_t word_shift = shift / BITBOARD_WORD_BITS;
+    int bit_shift = shift % BITBOARD_WORD_BITS;
+    if (word + word_shift >= words.size())
+        return 0;
+    unsigned long tmp_word = words[word + word_shift] >> bit_shift;
+    if (bit_shift and word + word_shift + 1 < words.size())
+        tmp_word |= words[word + word_shift + 1] << (BITBOARD_WORD_BITS - bit_shift);
+    return tmp_word;
+}
+
+void Bitboard::flood(Bitboard &passable, int row_width)
+// Grows the set bits through the 4-neighbourhood inside passable until nothing changes
+// A step east is a shift up by one, a step south a shift up by row_width; passable must have a border of
+// cleared cells (the walls around the flat map) so a step cannot wrap to the next row
+// The words are updated in place, which only makes the board converge faster since it never grows past the fixed point
+{
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < words.size(); i++) {
+            unsigned long tmp_word = words[i]
+                | shifted_up(i, 1)
+                | shifted_down(i, 1)
+                | shifted_up(i, row_width)
+                | shifted_down(i, row_width);
+            tmp_word &= passable.words[i];
+            if (tmp_word != words[i]) {
+                words[i] = tmp_word;
+                changed = true;
+            }
+        }
+    }
+}
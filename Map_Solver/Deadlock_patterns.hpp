@@ -0,0 +1,243 @@
+//
+//  Deadlock_patterns.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Library include
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Class include
+#include "Map.hpp"
+
+// Defines
+#define     PATTERN_SIZE       4 // deadlock patterns are PATTERN_SIZE x PATTERN_SIZE windows; the masks have one bit per window cell
+#define     PATTERN_FILE_SUFFIX  ".deadlocks" // the pattern file is stored next to the map as the map file name with this suffix
+#define     PATTERN_FILE_MAGIC   0x4c444b53 // "SKDL"
+#define     PATTERN_FILE_VERSION 2 // raised whenever the file layout or the pattern learning changes; older files are ignored
+
+// Namespaces
+using namespace std;
+
+class Deadlock_patterns
+// Deadlock patterns learned by the corral test on one map. Boxes on the box cells of a pattern are a deadlock unless the
+// worker is on one of its corral cells. Walls are static so a pattern is stored at the cell of its top-left window corner
+// (origin) and only holds the two masks; the patterns can be saved next to the map so later runs start with them.
+{
+public:
+	// Constructor, overload constructor, and destructor
+    Deadlock_patterns();
+    ~Deadlock_patterns();
+
+	// Public Methods
+    void set_map(Map* map_ptr);
+    bool learn(vector< int > &box_cells, vector< int > &corral_cells);
+    bool match(const cell_t* in_boxes, int in_box_count, int box_cell, int worker_cell);
+    void merge(Deadlock_patterns &in_patterns);
+    bool load();
+    bool save();
+    size_t size();
+    bool changed();
+
+private:
+    struct deadlock_pattern {
+        unsigned short box_mask;
+        unsigned short corral_mask; // window cells the worker could not reach when the pattern was proven
+    };
+
+	// Private variables
+    Map* map = nullptr;
+    vector< vector< deadlock_pattern > > patterns_at; // indexed by origin cell
+    size_t pattern_count = 0;
+    bool patterns_changed = false; // patterns were added since the last load or save
+    static mutex file_mutex; // the solvers of a batch share the pattern file of their map
+
+	// Private Methods
+    bool add(int origin, deadlock_pattern in_pattern);
+    bool box_at(const cell_t* in_boxes, int in_box_count, int in_cell);
+    unsigned int map_hash();
+};
+
+mutex Deadlock_patterns::file_mutex;
+
+Deadlock_patterns::Deadlock_patterns()
+// Default constructor
+{
+}
+
+Deadlock_patterns::~Deadlock_patterns()
+// Default destructor
+{
+}
+
+void Deadlock_patterns::set_map(Map* map_ptr)
+// Sets the map the patterns belong to and drops all patterns
+{
+    map = map_ptr;
+    patterns_at.assign(map->get_cells(), vector< deadlock_pattern >());
+    pattern_count = 0;
+    patterns_changed = false;
+}
+
+bool Deadlock_patterns::learn(vector< int > &box_cells, vector< int > &corral_cells)
+// Stores the boxes of a corral proven deadlocked and the cells the worker cannot reach with only those boxes on the map
+// as a pattern; returns false if the cells do not fit in one window or the pattern is known already
+{
+    int min_x = map->get_width(), min_y = map->get_height(), max_x = -1, max_y = -1;
+    for (size_t i = 0; i < box_cells.size() + corral_cells.size(); i++) {
+        int tmp_cell = i < box_cells.size() ? box_cells[i] : corral_cells[i - box_cells.size()];
+        min_x = min(min_x, map->cell_x(tmp_cell));
+        min_y = min(min_y, map->cell_y(tmp_cell));
+        max_x = max(max_x, map->cell_x(tmp_cell));
+        max_y = max(max_y, map->cell_y(tmp_cell));
+    }
+    if (max_x - min_x >= PATTERN_SIZE or max_y - min_y >= PATTERN_SIZE)
+        return false;
+    deadlock_pattern tmp_pattern = {0, 0};
+    for (size_t i = 0; i < box_cells.size(); i++)
+        tmp_pattern.box_mask |= 1 << ((map->cell_y(box_cells[i]) - min_y) * PATTERN_SIZE + map->cell_x(box_cells[i]) - min_x);
+    for (size_t i = 0; i < corral_cells.size(); i++)
+        tmp_pattern.corral_mask |= 1 << ((map->cell_y(corral_cells[i]) - min_y) * PATTERN_SIZE + map->cell_x(corral_cells[i]) - min_x);
+    return add(map->cell_index(min_x, min_y), tmp_pattern);
+}
+
+bool Deadlock_patterns::match(const cell_t* in_boxes, int in_box_count, int box_cell, int worker_cell)
+// Tests the patterns of every window containing the box just pushed onto box_cell; the worker stands on worker_cell
+// Only patterns with a box on box_cell are tested since the others would already have matched the parent
+{
+    if (pattern_count == 0)
+        return false;
+    int row_step = map->cell_step(2); // one row down (south)
+    int box_x = map->cell_x(box_cell);
+    int box_y = map->cell_y(box_cell);
+    int worker_x = map->cell_x(worker_cell);
+    int worker_y = map->cell_y(worker_cell);
+    for (int dy = 0; dy < PATTERN_SIZE and dy <= box_y; dy++) {
+        for (int dx = 0; dx < PATTERN_SIZE and dx <= box_x; dx++) {
+            int origin = map->cell_index(box_x - dx, box_y - dy);
+            for (size_t i = 0; i < patterns_at[origin].size(); i++) {
+                deadlock_pattern &tmp_pattern = patterns_at[origin][i];
+                if (!(tmp_pattern.box_mask >> (dy * PATTERN_SIZE + dx) & 1))
+                    continue;
+                int worker_dx = worker_x - (box_x - dx);
+                int worker_dy = worker_y - (box_y - dy);
+                if (worker_dx >= 0 and worker_dx < PATTERN_SIZE and worker_dy >= 0 and worker_dy < PATTERN_SIZE
+                    and (tmp_pattern.corral_mask >> (worker_dy * PATTERN_SIZE + worker_dx) & 1))
+                    continue;
+                bool pattern_match = true;
+                for (int bit = 0; bit < PATTERN_SIZE * PATTERN_SIZE and pattern_match; bit++)
+                    if ((tmp_pattern.box_mask >> bit & 1) and !box_at(in_boxes, in_box_count, origin + (bit / PATTERN_SIZE) * row_step + bit % PATTERN_SIZE))
+                        pattern_match = false;
+                if (pattern_match)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Deadlock_patterns::merge(Deadlock_patterns &in_patterns)
+// Adds the patterns of another solver on the same map, e.g. the ones an HDA worker learned
+{
+    for (size_t origin = 0; origin < in_patterns.patterns_at.size(); origin++)
+        for (size_t i = 0; i < in_patterns.patterns_at[origin].size(); i++)
+            add(origin, in_patterns.patterns_at[origin][i]);
+    in_patterns.patterns_changed = false;
+}
+
+bool Deadlock_patterns::load()
+// Loads the patterns learned by earlier runs on the same map; returns false if there is no usable file
+{
+    lock_guard< mutex > file_lock(file_mutex);
+    ifstream pattern_file(map->get_file_name() + PATTERN_FILE_SUFFIX, ios::binary);
+    if (!pattern_file.is_open())
+        return false;
+    unsigned int header[6]; // magic, version, width, height, map hash and number of patterns
+    if (!pattern_file.read((char*)header, sizeof(header)) or header[0] != PATTERN_FILE_MAGIC or header[1] != PATTERN_FILE_VERSION
+        or header[2] != (unsigned int)map->get_width() or header[3] != (unsigned int)map->get_height()
+        or header[4] != map_hash())
+        return false; // the file does not belong to this map or version
+    for (unsigned int i = 0; i < header[5]; i++) {
+        int origin;
+        deadlock_pattern tmp_pattern;
+        if (!pattern_file.read((char*)&origin, sizeof(origin)) or !pattern_file.read((char*)&tmp_pattern, sizeof(tmp_pattern)))
+            break;
+        if (origin < 0 or origin >= map->get_cells())
+            continue;
+        patterns_at[origin].push_back(tmp_pattern);
+        pattern_count++;
+    }
+    return true;
+}
+
+bool Deadlock_patterns::save()
+// Saves all patterns to the file next to the map so later runs start with them
+{
+    lock_guard< mutex > file_lock(file_mutex);
+    ofstream pattern_file(map->get_file_name() + PATTERN_FILE_SUFFIX, ios::binary | ios::trunc);
+    if (!pattern_file.is_open())
+        return false;
+    unsigned int header[6] = {PATTERN_FILE_MAGIC, PATTERN_FILE_VERSION, (unsigned int)map->get_width(), (unsigned int)map->get_height(),
+                              map_hash(), (unsigned int)pattern_count};
+    pattern_file.write((char*)header, sizeof(header));
+    for (int origin = 0; origin < map->get_cells(); origin++) {
+        for (size_t i = 0; i < patterns_at[origin].size(); i++) {
+            pattern_file.write((char*)&origin, sizeof(origin));
+            pattern_file.write((char*)&patterns_at[origin][i], sizeof(deadlock_pattern));
+        }
+    }
+    patterns_changed = false;
+    return pattern_file.good();
+}
+
+size_t Deadlock_patterns::size()
+// Returns the number of patterns
+{
+    return pattern_count;
+}
+
+bool Deadlock_patterns::changed()
+// Returns true if patterns were added since they were loaded or saved
+{
+    return patterns_changed;
+}
+
+bool Deadlock_patterns::add(int origin, deadlock_pattern in_pattern)
+// Stores the pattern at its origin cell unless the same masks are stored there already; returns true if it was added
+{
+    for (size_t i = 0; i < patterns_at[origin].size(); i++)
+        if (patterns_at[origin][i].box_mask == in_pattern.box_mask and patterns_at[origin][i].corral_mask == in_pattern.corral_mask)
+            return false;
+    patterns_at[origin].push_back(in_pattern);
+    pattern_count++;
+    patterns_changed = true;
+    return true;
+}
+
+bool Deadlock_patterns::box_at(const cell_t* in_boxes, int in_box_count, int in_cell)
+// Tests if there is a box at the cell; the boxes are sorted so the scan stops early
+{
+    for (int i = 0; i < in_box_count and in_boxes[i] <= in_cell; i++)
+        if (in_boxes[i] == in_cell)
+            return true;
+    return false;
+}
+
+unsigned int Deadlock_patterns::map_hash()
+// Returns a hash (FNV-1a) of the flags of all cells; the patterns are keyed by cell index, so they only hold for a map
+// with the same walls, goals and dead cells
+{
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < map->get_cells(); i++) {
+        hash ^= map->cell_flags(i);
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,207 @@
+//
+//  Hash_table.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Library include
+#include <vector>
+
+// Defines
+#define HASH_TABLE_INITIAL_SIZE     1024 // must be a power of two
+#define HASH_TABLE_MAX_LOAD         0.7  // the table doubles when this fraction of the slots is used
+
+// Namespaces
+using namespace std;
+
+template <class node_type>
+class Hash_table
+// Flat open-addressing hash table using linear probing; maps a hash value to a node pointer.
+// A slot is empty when its ref_node is the nullptr so the nodes stored must never be the nullptr.
+// Without a match function two nodes are the same when their hash values are equal; with one the
+// stored node must also match the input node, so colliding hash values are kept as separate entries.
+{
+public:
+    struct hash_node {
+        unsigned long hash_value;
+        node_type* ref_node;
+    };
+
+	// Constructor, overload constructor, and destructor
+    Hash_table();
+    ~Hash_table();
+
+	// Public Methods
+    bool insert(unsigned long in_hash_value, node_type* &in_node);
+    bool exist(unsigned long in_hash_value, node_type* &in_node);
+    bool remove(unsigned long in_hash_value, node_type* in_node);
+    void set_match_function(bool (*in_match)(void*, node_type*, node_type*), void* in_match_context);
+    void clear();
+    size_t size();
+    size_t capacity();
+
+private:
+	// Private variables
+    vector< hash_node > table;
+    size_t elements = 0;
+    size_t mask = 0; // table.size()-1
+    int    shift = 0; // 64-log2(table.size())
+    bool (*match)(void*, node_type*, node_type*) = nullptr;
+    void* match_context = nullptr; // passed as the first argument of match
+
+	// Private Methods
+    size_t slot_of(unsigned long in_hash_value);
+    bool   slot_matches(size_t slot, unsigned long in_hash_value, node_type* in_node);
+    void   resize(size_t new_size);
+};
+
+template <class node_type>
+Hash_table<node_type>::Hash_table()
+// Default constructor
+{
+    resize(HASH_TABLE_INITIAL_SIZE);
+}
+
+template <class node_type>
+Hash_table<node_type>::~Hash_table()
+// Default destructor; the nodes are owned by the caller
+{
+}
+
+template <class node_type>
+size_t Hash_table<node_type>::slot_of(unsigned long in_hash_value)
+// Home slot of a hash value (Fibonacci hashing, so keys with poor low bits still spread over the table)
+{
+    return (size_t)((in_hash_value * 0x9E3779B97F4A7C15UL) >> shift);
+}
+
+template <class node_type>
+bool Hash_table<node_type>::slot_matches(size_t slot, unsigned long in_hash_value, node_type* in_node)
+// Tests if the occupied slot holds the element described by the hash value and input node
+{
+    if (table[slot].hash_value != in_hash_value)
+        return false;
+    return match == nullptr or table[slot].ref_node == in_node or match(match_context, table[slot].ref_node, in_node);
+}
+
+template <class node_type>
+void Hash_table<node_type>::set_match_function(bool (*in_match)(void*, node_type*, node_type*), void* in_match_context)
+// Sets the full equality test used when two hash values are equal; the nullptr disables it
+{
+    match = in_match;
+    match_context = in_match_context;
+}
+
+template <class node_type>
+void Hash_table<node_type>::resize(size_t new_size)
+// Allocates a table with new_size slots and reinserts all elements
+{
+    vector< hash_node > old_table;
+    old_table.swap(table);
+    table.assign(new_size, hash_node{0, nullptr});
+    mask = new_size-1;
+    shift = 64;
+    for (size_t i = new_size; i > 1; i >>= 1)
+        shift--;
+
+    for (size_t i = 0; i < old_table.size(); i++) {
+        if (old_table[i].ref_node != nullptr) {
+            size_t slot = slot_of(old_table[i].hash_value);
+            while (table[slot].ref_node != nullptr)
+                slot = (slot+1) & mask;
+            table[slot] = old_table[i];
+        }
+    }
+}
+
+template <class node_type>
+bool Hash_table<node_type>::insert(unsigned long in_hash_value, node_type* &in_node)
+// Inserts with amortised constant time
+// if the element exists the in_node is changed to the existing element so it can be used for futher processing
+// return true if element is inserted and false if it already exists
+{
+    if (elements+1 > HASH_TABLE_MAX_LOAD * table.size())
+        resize(table.size()*2);
+
+    size_t slot = slot_of(in_hash_value);
+    while (table[slot].ref_node != nullptr) {
+        if (slot_matches(slot, in_hash_value, in_node)) {
+            in_node = table[slot].ref_node;
+            return false;
+        }
+        slot = (slot+1) & mask;
+    }
+    table[slot].hash_value = in_hash_value;
+    table[slot].ref_node = in_node;
+    elements++;
+    return true;
+}
+
+template <class node_type>
+bool Hash_table<node_type>::exist(unsigned long in_hash_value, node_type* &in_node)
+// Searches for a element in the hash table and if it exists the pointer to the found object is passes back in in_node and it returns true; otherwise no pointer return and false return value
+{
+    size_t slot = slot_of(in_hash_value);
+    while (table[slot].ref_node != nullptr) {
+        if (slot_matches(slot, in_hash_value, in_node)) {
+            in_node = table[slot].ref_node;
+            return true;
+        }
+        slot = (slot+1) & mask;
+    }
+    return false;
+}
+
+template <class node_type>
+bool Hash_table<node_type>::remove(unsigned long in_hash_value, node_type* in_node)
+// Deletes an element in the table if it exists (return value true)
+// Uses backward shift deletion so no tombstones are needed and probe sequences stay short
+{
+    size_t slot = slot_of(in_hash_value);
+    while (table[slot].ref_node != nullptr) {
+        if (slot_matches(slot, in_hash_value, in_node)) {
+            size_t hole = slot;
+            size_t next = (hole+1) & mask;
+            while (table[next].ref_node != nullptr) {
+                size_t home = slot_of(table[next].hash_value);
+                // Move the element back if its home slot is not cyclically in (hole, next]
+                if ( ((next-home) & mask) >= ((next-hole) & mask) ) {
+                    table[hole] = table[next];
+                    hole = next;
+                }
+                next = (next+1) & mask;
+            }
+            table[hole].ref_node = nullptr;
+            elements--;
+            return true;
+        }
+        slot = (slot+1) & mask;
+    }
+    return false;
+}
+
+template <class node_type>
+void Hash_table<node_type>::clear()
+// Removes all elements and shrinks the table to the initial size
+{
+    table.clear();
+    elements = 0;
+    resize(HASH_TABLE_INITIAL_SIZE);
+}
+
+template <class node_type>
+size_t Hash_table<node_type>::size()
+// Returns the number of elements in the table
+{
+    return elements;
+}
+
+template <class node_type>
+size_t Hash_table<node_type>::capacity()
+// Returns the number of slots in the table
+{
+    return table.size();
+}
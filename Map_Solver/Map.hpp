@@ -23,6 +23,11 @@
 #define worker 		6
 #define undefined   9
 
+// Cell flags of the flat map
+#define CELL_WALL       1 // obstacle or the sentinel border
+#define CELL_BOX_DEAD   2 // a box on the cell can never reach a goal (see create_deadlock_free_map)
+#define CELL_GOAL       4
+
 // Namespaces
 using namespace std;
 
@@ -41,6 +46,7 @@ public:
 	bool load_map_from_file(string file_name);
 	bool create_deadlock_free_map();
 	void create_wavefront_map();
+	void create_push_distance_map();
 	void print_map();
 	void print_map(point2D& in_worker_pos, vector< point2D > in_boxes_pos, bool print_descriptor);
 	void print_map_simple(int map_type);
@@ -51,19 +57,30 @@ public:
 	int  map_point_type(point2D &inPoint, int map_type);
 	int  wavefront_distance(int in_x, int in_y, int goal_id);
 	int  wavefront_distance(point2D &inPoint, int goal_id);
+	int  push_distance(int in_x, int in_y, int goal_id);
+	int  push_distance(point2D &inPoint, int goal_id);
 
 	vector< vector<int> > get_map(int map_type);
 	vector< point2D > get_goals();
 	vector< point2D > get_boxes();
 	point2D get_worker();
+	string get_file_name();
 	int  get_width();
 	int  get_height();
+	int  get_cells();
+	int  cell_index(int in_x, int in_y);
+	int  cell_x(int in_cell);
+	int  cell_y(int in_cell);
+	int  side_neighbour(int in_cell, int in_side);
+	int  cell_step(int in_side);
+	unsigned char cell_flags(int in_cell);
 
 private:
 	// Private variables
 	vector< vector<int> >  map_worker; // outer vector holds rows and therefore the internal vector is the column, ex. map_worker.at(y).at(x)
 	vector< vector<int> >  map_box;
 	vector< vector< vector<int> > >  map_wavefront;
+	vector< vector< vector<int> > >  map_push_distance; // pushes needed to get a box to the goal; -1 if it cannot get there
 
 	vector< point2D > initial_pos_goals;
 	vector< point2D > initial_pos_boxes;
@@ -73,8 +90,15 @@ private:
 	int map_width       = 0;
 	int map_obstacles   = 0;
 	bool empty_map 		= true; // true if empty; false if not empty
+	string map_file_name; // file the map was loaded from
+
+	// Flat map; one byte of CELL_* flags per cell with a one cell wall border so a neighbour of a map cell always exists
+	vector< unsigned char > map_cells;
+	int padded_width    = 0; // map_width + 2
+	int side_offset[4]  = {0, 0, 0, 0}; // cell index offset to the north, east, south and west neighbour
 
 	// Private Methods
+	void create_cells();
 };
 
 Map::Map()
@@ -109,6 +133,7 @@ bool Map::load_map_from_file(string file_name)
 	ifstream map_file (file_name);
 	if (map_file.is_open())
 	{
+		map_file_name = file_name;
 		cout << "Loading: " << file_name << endl;
 		for (size_t i = 1; getline (map_file,line); i++) {
 			if (i == 1) { // Catch first line which contains map info; XX YY DD, XX=width, YY=height, DD=obstacles
@@ -152,6 +177,7 @@ bool Map::load_map_from_file(string file_name)
 			cout << "The number og goals and boxes does not match!" << endl << endl;
 			return false;
 		}
+		create_cells();
 		cout << "Loading successful!" << endl << endl;
 		empty_map = false;
 		return true;
@@ -163,93 +189,67 @@ bool Map::load_map_from_file(string file_name)
 
 bool Map::create_deadlock_free_map()
 // Creates a deadlock free map; a map for the boxes so the worker cannot push a box into an already deadlocked position
+// A box is pulled backwards from every goal; a pull moves the box one cell and needs a free cell beyond it for the worker
+// Every cell the box can never be pulled to is a dead square since no sequence of pushes can bring a box from it to a goal
+// Returns false if a box starts on a dead square; the map cannot be solved then
 {
 	for (size_t i = 0; i < map_worker.size(); i++) { // copy map
 		map_box.push_back(map_worker.at(i));
 	}
-	for (size_t y = 0; y < map_box.size(); y++) { // outer vector is y
-		for (size_t x = 0; x < map_box.at(y).size(); x++) { // inner vector is x
-			point2D tmp_point;
-			tmp_point.x = x;
-			tmp_point.y = y;
-			if ( (x > 0 and x < map_box.at(y).size()-1) and (y > 0 and y < map_box.size()-1) ) {
-				if ( ( (map_worker.at(y-1).at(x) == obstacle and map_worker.at(y).at(x+1) == obstacle)
-					or (map_worker.at(y).at(x+1) == obstacle and map_worker.at(y+1).at(x) == obstacle)
-					or (map_worker.at(y+1).at(x) == obstacle and map_worker.at(y).at(x-1) == obstacle)
-					or (map_worker.at(y).at(x-1) == obstacle and map_worker.at(y-1).at(x) == obstacle) )
-					and (map_point_type(tmp_point,worker) != goal) ) {
-
-					map_box.at(y).at(x) = obstacle;
-				}
-			}
+	vector<bool> box_alive(map_cells.size(), false);
+	vector<int> pull_queue;
+	for (size_t i = 0; i < initial_pos_goals.size(); i++) {
+		int goal_cell = cell_index(initial_pos_goals.at(i).x, initial_pos_goals.at(i).y);
+		if (!box_alive.at(goal_cell)) {
+			box_alive.at(goal_cell) = true;
+			pull_queue.push_back(goal_cell);
 		}
 	}
-	// check rows for deadlozed zones
-	for (size_t y = 0; y < map_box.size(); y++) {
-		int last_freespace_x = 0;
-		for (size_t x = 0; x < map_box.at(y).size(); x++) {
-			bool create_deadlocked_zone = true;
-			bool goal_in_zone = false;
-			if ( (map_point_type(x,y, worker) == freespace) and (map_point_type(x-1,y, worker) == obstacle) and ( x > last_freespace_x) ) {
-				for (size_t x_tmp = x; x_tmp < map_box.at(y).size(); x_tmp++) {
-					if (map_point_type(x_tmp,y, worker) == goal)
-						goal_in_zone = true;
-					if (map_point_type(x_tmp,y, worker) == obstacle) {
-						last_freespace_x = x_tmp-1;
-						if (!goal_in_zone) {
-							bool prev_row = false;
-							bool next_row = false;
-							for (size_t x_prev_y = x; x_prev_y <= last_freespace_x; x_prev_y++) {
-								if (map_point_type(x_prev_y,y-1, worker) != obstacle)
-									prev_row = true;
-								if (map_point_type(x_prev_y,y+1, worker) != obstacle)
-									next_row = true;
-							}
-							if (!prev_row or !next_row)
-								for (size_t x_mark = x; x_mark < last_freespace_x; x_mark++)
-									map_box.at(y).at(x_mark) = obstacle;
-						}
-						break;
-					}
-				}
+	for (size_t q = 0; q < pull_queue.size(); q++) {
+		for (int d = 0; d < 4; d++) {
+			int pulled = pull_queue.at(q) + side_offset[d];
+			if (box_alive.at(pulled) or (map_cells.at(pulled) & CELL_WALL) or (map_cells.at(pulled + side_offset[d]) & CELL_WALL))
+				continue;
+			box_alive.at(pulled) = true;
+			pull_queue.push_back(pulled);
+		}
+	}
+	for (int y = 0; y < map_height; y++) {
+		for (int x = 0; x < map_width; x++) {
+			if (map_cells.at(cell_index(x, y)) & CELL_WALL)
+				continue;
+			if (!box_alive.at(cell_index(x, y))) {
+				map_box.at(y).at(x) = obstacle;
+				map_cells.at(cell_index(x, y)) |= CELL_BOX_DEAD;
 			}
 		}
 	}
-	// check cols for deadlozed zones
-	for (size_t x = 0; x < map_box.at(0).size(); x++) {
-	    int last_freespace_y = 0;
-
-	    for (size_t y = 0; y < map_box.size(); y++) {
-	        bool create_deadlocked_zone = true;
-	        bool goal_in_zone = false;
-	        if ( (map_point_type(x,y, worker) == freespace) and (map_point_type(x,y-1, worker) == obstacle) and ( y > last_freespace_y) ) {
-	            for (size_t y_tmp = y; y_tmp < map_box.size(); y_tmp++) {
-	                if (map_point_type(x,y_tmp, worker) == goal)
-	                    goal_in_zone = true;
-	                if (map_point_type(x,y_tmp, worker) == obstacle) {
-	                    last_freespace_y = y_tmp-1;
-	                    if (!goal_in_zone) {
-	                        bool prev_row = false;
-	                        bool next_row = false;
-	                        for (size_t y_prev_x = y; y_prev_x <= last_freespace_y; y_prev_x++) {
-	                            if (map_point_type(x-1,y_prev_x, worker) != obstacle)
-	                                prev_row = true;
-	                            if (map_point_type(x+1,y_prev_x, worker) != obstacle)
-	                                next_row = true;
-	                        }
-	                        if (!prev_row or !next_row)
-	                            for (size_t y_mark = y; y_mark < last_freespace_y; y_mark++)
-	                                map_box.at(y_mark).at(x) = obstacle;
-	                    }
-	                    break;
-	                }
-	            }
-	        }
-	    }
+	for (size_t i = 0; i < initial_pos_boxes.size(); i++) {
+		if (!box_alive.at(cell_index(initial_pos_boxes.at(i).x, initial_pos_boxes.at(i).y))) {
+			cout << "The box at " << initial_pos_boxes.at(i).x << ", " << initial_pos_boxes.at(i).y << " can never reach a goal!" << endl << endl;
+			return false;
+		}
 	}
 	return true;
 }
 
+void Map::create_cells()
+// Creates the flat map from map_worker and the goals; cells outside the rows of the file are walls
+{
+	padded_width = map_width + 2;
+	side_offset[0] = -padded_width;
+	side_offset[1] = 1;
+	side_offset[2] = padded_width;
+	side_offset[3] = -1;
+	map_cells.assign(padded_width * (map_height + 2), CELL_WALL);
+	for (int y = 0; y < map_height and y < (int)map_worker.size(); y++)
+		for (int x = 0; x < map_width and x < (int)map_worker.at(y).size(); x++)
+			if (map_worker.at(y).at(x) != obstacle)
+				map_cells.at(cell_index(x, y)) = 0;
+	for (size_t i = 0; i < initial_pos_goals.size(); i++)
+		map_cells.at(cell_index(initial_pos_goals.at(i).x, initial_pos_goals.at(i).y)) |= CELL_GOAL;
+}
+
 void Map::create_wavefront_map()
 // Explanation
 {
@@ -305,6 +305,100 @@ void Map::create_wavefront_map()
 	}
 }
 
+void Map::create_push_distance_map()
+// Creates a map per goal with the minimum number of pushes needed to get a box from each cell onto the goal
+// Unlike the wavefront it respects the worker; a push needs a free cell behind the box and the box may not pass dead cells of map_box
+// The maps are made by pulling a box away from the goal: a box at cell c pulled towards side d ends at c+d with the worker at c+2d
+// Between pulls the worker can walk to every side of the box it can reach with the box as an obstacle
+// Cells from which the goal cannot be reached get -1
+{
+	int cells = get_cells();
+	vector<bool> floor_cell(cells);
+	vector<bool> box_cell(cells);
+	for (int i = 0; i < cells; i++) {
+		int tmp_type = map_point_type(cell_x(i), cell_y(i), worker);
+		floor_cell.at(i) = (tmp_type != obstacle and tmp_type != undefined);
+		tmp_type = map_point_type(cell_x(i), cell_y(i), box);
+		box_cell.at(i) = (tmp_type != obstacle and tmp_type != undefined);
+	}
+
+	// side_region[c*4+d] is the region of the side d of a box at c; two sides with equal regions are connected for the worker
+	vector<int> side_region(cells*4, -1);
+	vector<int> region_of(cells);
+	vector<int> region_queue;
+	for (int c = 0; c < cells; c++) {
+		if (!box_cell.at(c))
+			continue;
+		for (int i = 0; i < cells; i++)
+			region_of.at(i) = -1;
+		for (int d = 0; d < 4; d++) {
+			int side = side_neighbour(c, d);
+			if (side < 0 or !floor_cell.at(side))
+				continue;
+			if (region_of.at(side) < 0) {
+				region_queue.clear();
+				region_queue.push_back(side);
+				region_of.at(side) = d;
+				for (size_t q = 0; q < region_queue.size(); q++) {
+					for (int k = 0; k < 4; k++) {
+						int next = side_neighbour(region_queue.at(q), k);
+						if (next >= 0 and next != c and floor_cell.at(next) and region_of.at(next) < 0) {
+							region_of.at(next) = d;
+							region_queue.push_back(next);
+						}
+					}
+				}
+			}
+			side_region.at(c*4+d) = region_of.at(side);
+		}
+	}
+
+	map_push_distance.clear();
+	for (size_t map_nr = 0; map_nr < initial_pos_goals.size(); map_nr++) {
+		vector<int> state_distance(cells*4, -1); // box at c with the worker at side d
+		vector<int> layer;
+		vector<int> next_layer;
+		int goal_cell = cell_index(initial_pos_goals.at(map_nr).x, initial_pos_goals.at(map_nr).y);
+		for (int d = 0; d < 4; d++) {
+			if (side_region.at(goal_cell*4+d) >= 0) {
+				state_distance.at(goal_cell*4+d) = 0;
+				layer.push_back(goal_cell*4+d);
+			}
+		}
+		for (int distance = 0; layer.size(); distance++) {
+			next_layer.clear();
+			for (size_t q = 0; q < layer.size(); q++) {
+				int c = layer.at(q) / 4;
+				int d = layer.at(q) % 4;
+				for (int k = 0; k < 4; k++) { // walk to the other sides of the box
+					int state = c*4+k;
+					if (side_region.at(state) >= 0 and side_region.at(state) == side_region.at(c*4+d) and state_distance.at(state) < 0) {
+						state_distance.at(state) = distance;
+						layer.push_back(state);
+					}
+				}
+				int pulled = c + side_offset[d];
+				int behind = side_neighbour(pulled, d);
+				if (box_cell.at(pulled) and behind >= 0 and floor_cell.at(behind) and state_distance.at(pulled*4+d) < 0) {
+					state_distance.at(pulled*4+d) = distance+1;
+					next_layer.push_back(pulled*4+d);
+				}
+			}
+			layer.swap(next_layer);
+		}
+
+		vector< vector<int> > tmp_distance(map_height, vector<int>(map_width, -1));
+		for (int c = 0; c < cells; c++) {
+			for (int d = 0; d < 4; d++) {
+				int tmp_value = state_distance.at(c*4+d);
+				if (tmp_value >= 0 and (tmp_distance.at(cell_y(c)).at(cell_x(c)) < 0 or tmp_value < tmp_distance.at(cell_y(c)).at(cell_x(c))))
+					tmp_distance.at(cell_y(c)).at(cell_x(c)) = tmp_value;
+			}
+		}
+		map_push_distance.push_back(tmp_distance);
+	}
+}
+
 void Map::print_map()
 // An overload function for the print_map
 {
@@ -503,32 +597,29 @@ int Map::map_point_type(int in_x, int in_y, int map_type)
 int Map::map_point_type(point2D &inPoint, int map_type)
 // Returns the point type but only freespace, obstacles, or goals
 {
-	vector< vector<int> >* map_ptr;
-	if (map_type == worker) {
-		 map_ptr = &map_worker;
-	} else if (map_type == box) {
-		map_ptr = &map_box;
-	} else {
+	if (map_type != worker and map_type != box) {
 		cout << "Unkown map type specified" << endl;
 		return undefined;
 	}
 	if ( (inPoint.x >= 0 and inPoint.x < map_width) and (inPoint.y >= 0 and inPoint.y < map_height) ) {
-		for (size_t i = 0; i < initial_pos_goals.size(); i++)
-	        if (initial_pos_goals.at(i).x == inPoint.x and initial_pos_goals.at(i).y == inPoint.y)
-	            return goal;
-		return map_ptr->at(inPoint.y).at(inPoint.x);
+		unsigned char tmp_flags = map_cells[cell_index(inPoint.x, inPoint.y)];
+		if (tmp_flags & CELL_GOAL)
+			return goal;
+		if ((tmp_flags & CELL_WALL) or (map_type == box and (tmp_flags & CELL_BOX_DEAD)))
+			return obstacle;
+		return freespace;
 	} else {
 		return undefined;
 	}
 }
 
 int Map::wavefront_distance(int in_x, int in_y, int goal_id)
-// An overload function for the map_point_type
+// An overload function for the wavefront_distance
 {
 	point2D tmp_point;
 	tmp_point.x = in_x;
 	tmp_point.y = in_y;
-	return map_point_type(tmp_point, goal_id);
+	return wavefront_distance(tmp_point, goal_id);
 }
 int Map::wavefront_distance(point2D &inPoint, int goal_id)
 // Returns the point type but only freespace, obstacles, or goals
@@ -536,6 +627,26 @@ int Map::wavefront_distance(point2D &inPoint, int goal_id)
 	return map_wavefront.at(goal_id).at(inPoint.y).at(inPoint.x);
 }
 
+int Map::push_distance(int in_x, int in_y, int goal_id)
+// An overload function for the push_distance
+{
+	point2D tmp_point;
+	tmp_point.x = in_x;
+	tmp_point.y = in_y;
+	return push_distance(tmp_point, goal_id);
+}
+int Map::push_distance(point2D &inPoint, int goal_id)
+// Returns the number of pushes needed to get a box from the point to the goal or -1 if the box cannot get there
+{
+	return map_push_distance.at(goal_id).at(inPoint.y).at(inPoint.x);
+}
+
+string Map::get_file_name()
+// Returns the name of the file the map was loaded from
+{
+	return map_file_name;
+}
+
 int  Map::get_width()
 // Returns the width of the map (x-axis positive right)
 {
@@ -546,3 +657,41 @@ int  Map::get_height()
 {
 	return map_height;
 }
+int  Map::get_cells()
+// Returns the number of cells in the flat map including the border; cell indices are 0 to get_cells()-1
+{
+	return padded_width * (map_height + 2);
+}
+int  Map::cell_index(int in_x, int in_y)
+// Returns the cell index of a position; the border makes x and y from -1 to width and height valid
+{
+	return (in_y + 1) * padded_width + in_x + 1;
+}
+int  Map::cell_x(int in_cell)
+// Returns the x coordinate of a cell index
+{
+	return in_cell % padded_width - 1;
+}
+int  Map::cell_y(int in_cell)
+// Returns the y coordinate of a cell index
+{
+	return in_cell / padded_width - 1;
+}
+int  Map::side_neighbour(int in_cell, int in_side)
+// Returns the cell next to the cell on the side (0 north, 1 east, 2 south, 3 west) or -1 outside the flat map
+{
+	int tmp_cell = in_cell + side_offset[in_side];
+	if (tmp_cell < 0 or tmp_cell >= (int)map_cells.size())
+		return -1;
+	return tmp_cell;
+}
+int  Map::cell_step(int in_side)
+// Returns the cell index offset to the neighbour on the side (0 north, 1 east, 2 south, 3 west)
+{
+	return side_offset[in_side];
+}
+unsigned char Map::cell_flags(int in_cell)
+// Returns the CELL_* flags of a cell
+{
+	return map_cells[in_cell];
+}
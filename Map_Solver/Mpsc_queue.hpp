@@ -0,0 +1,104 @@
+//
+//  Mpsc_queue.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Library include
+#include <atomic>
+
+// Namespaces
+using namespace std;
+
+struct mpsc_link
+// Link of an element of an Mpsc_queue; the element type derives from it
+{
+    atomic< mpsc_link* > next;
+};
+
+template <class node_type>
+class Mpsc_queue
+// Lock-free intrusive multi-producer single-consumer queue. Any thread may push while only the owning thread pops.
+// A push is one atomic exchange and never waits; a pop may return the nullptr while another thread is half way
+// through a push, the element is then returned by a later pop. The elements are owned by the caller.
+{
+public:
+	// Constructor, overload constructor, and destructor
+    Mpsc_queue();
+    ~Mpsc_queue();
+
+	// Public Methods
+    void push(node_type* in_node);
+    node_type* pop();
+
+private:
+	// Private variables
+    atomic< mpsc_link* > head; // last pushed link; exchanged by the producers
+    mpsc_link* tail; // next link to pop; only touched by the consumer
+    mpsc_link stub; // keeps the queue non-empty so head and tail are never the nullptr
+
+	// Private Methods
+    void push_link(mpsc_link* in_link);
+};
+
+template <class node_type>
+Mpsc_queue<node_type>::Mpsc_queue()
+// Default constructor; an empty queue only holds the stub
+{
+    stub.next.store(nullptr, memory_order_relaxed);
+    head.store(&stub, memory_order_relaxed);
+    tail = &stub;
+}
+
+template <class node_type>
+Mpsc_queue<node_type>::~Mpsc_queue()
+// Default destructor; the elements are owned by the caller
+{
+}
+
+template <class node_type>
+void Mpsc_queue<node_type>::push_link(mpsc_link* in_link)
+// Appends a link; the exchange orders the producers and the store publishes the link to the consumer
+{
+    in_link->next.store(nullptr, memory_order_relaxed);
+    mpsc_link* prev_link = head.exchange(in_link, memory_order_acq_rel);
+    prev_link->next.store(in_link, memory_order_release);
+}
+
+template <class node_type>
+void Mpsc_queue<node_type>::push(node_type* in_node)
+// Appends an element; may be called from any thread
+{
+    push_link(in_node);
+}
+
+template <class node_type>
+node_type* Mpsc_queue<node_type>::pop()
+// Removes and returns the oldest element or the nullptr if there is none (yet); only called by the owning thread
+{
+    mpsc_link* tmp_tail = tail;
+    mpsc_link* tmp_next = tmp_tail->next.load(memory_order_acquire);
+    if (tmp_tail == &stub) {
+        if (tmp_next == nullptr)
+            return nullptr;
+        tail = tmp_next;
+        tmp_tail = tmp_next;
+        tmp_next = tmp_next->next.load(memory_order_acquire);
+    }
+    if (tmp_next != nullptr) {
+        tail = tmp_next;
+        return static_cast< node_type* >(tmp_tail);
+    }
+    if (tmp_tail != head.load(memory_order_acquire))
+        return nullptr; // a producer has exchanged head but not linked its element yet
+    push_link(&stub); // put the stub behind the last element so the last element can be handed out
+    tmp_next = tmp_tail->next.load(memory_order_acquire);
+    if (tmp_next != nullptr) {
+        tail = tmp_next;
+        return static_cast< node_type* >(tmp_tail);
+    }
+    return nullptr;
+}
@@ -0,0 +1,131 @@
+//
+//  Node_arena.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Library include
+#include <algorithm>
+#include <new>
+#include <vector>
+
+// Defines
+#define NODE_ARENA_SLAB_NODES   4096 // nodes allocated at a time
+
+// Namespaces
+using namespace std;
+
+template <class node_type>
+class Node_arena
+// Slab allocator for search nodes. Released nodes are kept on an intrusive free list and reused
+// before a new slab is touched; all nodes still alive are destroyed when the arena is destroyed.
+{
+public:
+	// Constructor, overload constructor, and destructor
+    Node_arena();
+    ~Node_arena();
+
+	// Public Methods
+    template <class... Args> node_type* create(Args... args);
+    void   destroy(node_type* in_node);
+    void   release_all();
+    size_t size();
+    size_t capacity();
+
+private:
+    union slot {
+        slot* next_free;
+        alignas(node_type) unsigned char storage[sizeof(node_type)];
+    };
+
+	// Private variables
+    vector< slot* > slabs;
+    size_t slab_used = NODE_ARENA_SLAB_NODES; // slots handed out from the last slab
+    slot*  free_list = nullptr;
+    size_t live_nodes = 0;
+};
+
+template <class node_type>
+Node_arena<node_type>::Node_arena()
+// Default constructor; the first slab is allocated by the first create
+{
+}
+
+template <class node_type>
+Node_arena<node_type>::~Node_arena()
+// Default destructor; destroys the nodes that are still alive and frees the slabs
+{
+    release_all();
+}
+
+template <class node_type>
+template <class... Args>
+node_type* Node_arena<node_type>::create(Args... args)
+// Constructs a node with the given constructor arguments in a free slot
+{
+    slot* tmp_slot;
+    if (free_list != nullptr) {
+        tmp_slot = free_list;
+        free_list = free_list->next_free;
+    } else {
+        if (slab_used == NODE_ARENA_SLAB_NODES) {
+            slabs.push_back(static_cast< slot* >(::operator new(sizeof(slot) * NODE_ARENA_SLAB_NODES)));
+            slab_used = 0;
+        }
+        tmp_slot = slabs.back() + slab_used++;
+    }
+    live_nodes++;
+    return new (tmp_slot->storage) node_type(args...);
+}
+
+template <class node_type>
+void Node_arena<node_type>::destroy(node_type* in_node)
+// Destroys a node and puts its slot on the free list
+{
+    in_node->~node_type();
+    slot* tmp_slot = reinterpret_cast< slot* >(in_node);
+    tmp_slot->next_free = free_list;
+    free_list = tmp_slot;
+    live_nodes--;
+}
+
+template <class node_type>
+void Node_arena<node_type>::release_all()
+// Destroys every node that is still alive and frees all slabs in one go
+{
+    vector< slot* > free_slots;
+    for (slot* tmp_slot = free_list; tmp_slot != nullptr; tmp_slot = tmp_slot->next_free)
+        free_slots.push_back(tmp_slot);
+    sort(free_slots.begin(), free_slots.end());
+
+    for (size_t i = 0; i < slabs.size(); i++) {
+        size_t used = (i+1 == slabs.size()) ? slab_used : NODE_ARENA_SLAB_NODES;
+        for (size_t j = 0; j < used; j++) {
+            slot* tmp_slot = slabs[i] + j;
+            if (!binary_search(free_slots.begin(), free_slots.end(), tmp_slot))
+                reinterpret_cast< node_type* >(tmp_slot->storage)->~node_type();
+        }
+        ::operator delete(slabs[i]);
+    }
+    slabs.clear();
+    slab_used = NODE_ARENA_SLAB_NODES;
+    free_list = nullptr;
+    live_nodes = 0;
+}
+
+template <class node_type>
+size_t Node_arena<node_type>::size()
+// Returns the number of nodes alive
+{
+    return live_nodes;
+}
+
+template <class node_type>
+size_t Node_arena<node_type>::capacity()
+// Returns the number of node slots allocated
+{
+    return slabs.size() * NODE_ARENA_SLAB_NODES;
+}
@@ -0,0 +1,138 @@
+//
+//  Search_metrics.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Library include
+#include <chrono>
+#include <string>
+
+// Defines
+// The counters and timers are only compiled in with -DSEARCH_METRICS (make METRICS=-DSEARCH_METRICS); without it the
+// METRIC_* macros expand to nothing so the search does not pay for them. The macros expect a Search_metrics named metrics
+#ifdef SEARCH_METRICS
+#define METRIC_COUNT(counter)  (metrics.counter++)
+#define METRIC_TIME(phase)     Search_metrics::phase_timer phase##_timer(metrics, Search_metrics::phase)
+#else
+#define METRIC_COUNT(counter)  ((void)0)
+#define METRIC_TIME(phase)     ((void)0)
+#endif
+
+// Namespaces
+using namespace std;
+
+class Search_metrics
+// Counters and per-phase timers of one search. The phase times are inclusive: the move generation contains the hashing,
+// heuristic and deadlock tests of the successors it generates
+{
+public:
+    enum phase { phase_moves, phase_hashing, phase_heuristic, phase_goal_test, phase_count };
+
+    struct phase_timer
+    // Adds the time from its construction to its destruction to a phase
+    {
+        Search_metrics &metrics;
+        phase timed_phase;
+        chrono::steady_clock::time_point start_time;
+
+        phase_timer(Search_metrics &in_metrics, phase in_phase)
+        : metrics(in_metrics), timed_phase{ in_phase }, start_time{ chrono::steady_clock::now() } { }
+        ~phase_timer() {
+            metrics.phase_ns[timed_phase] += chrono::duration_cast< chrono::nanoseconds >(chrono::steady_clock::now() - start_time).count();
+            metrics.phase_calls[timed_phase]++;
+        }
+    };
+
+	// Constructor, overload constructor, and destructor
+    Search_metrics();
+    ~Search_metrics();
+
+	// Public variables
+    long expansions = 0;
+    long generations = 0; // new states added to the search
+    long duplicates = 0; // successors whose state was known already
+    long reparentings = 0; // known states reached with a smaller cost and moved to the new parent
+    long prunes_freeze = 0; // successors dropped by the deadlock tests
+    long prunes_corral = 0;
+    long prunes_pattern = 0;
+    long prunes_unreachable = 0; // a box cannot reach any free goal (heuristic)
+    long heap_pushes = 0;
+    long heap_pops = 0;
+    long heap_decrease_keys = 0;
+    long heap_removes = 0;
+    long hda_messages = 0; // children an HDA worker sent to the worker owning them
+    long long phase_ns[phase_count] = {0, 0, 0, 0};
+    long phase_calls[phase_count] = {0, 0, 0, 0};
+
+	// Public Methods
+    void reset();
+    void add(Search_metrics &in_metrics);
+    string to_json();
+};
+
+Search_metrics::Search_metrics()
+// Default constructor; all counters zero
+{
+}
+
+Search_metrics::~Search_metrics()
+// Default destructor
+{
+}
+
+void Search_metrics::reset()
+// Sets all counters and timers to zero
+{
+    *this = Search_metrics();
+}
+
+void Search_metrics::add(Search_metrics &in_metrics)
+// Adds the counters and timers of another search, e.g. of an HDA worker
+{
+    expansions += in_metrics.expansions;
+    generations += in_metrics.generations;
+    duplicates += in_metrics.duplicates;
+    reparentings += in_metrics.reparentings;
+    prunes_freeze += in_metrics.prunes_freeze;
+    prunes_corral += in_metrics.prunes_corral;
+    prunes_pattern += in_metrics.prunes_pattern;
+    prunes_unreachable += in_metrics.prunes_unreachable;
+    heap_pushes += in_metrics.heap_pushes;
+    heap_pops += in_metrics.heap_pops;
+    heap_decrease_keys += in_metrics.heap_decrease_keys;
+    heap_removes += in_metrics.heap_removes;
+    hda_messages += in_metrics.hda_messages;
+    for (int i = 0; i < phase_count; i++) {
+        phase_ns[i] += in_metrics.phase_ns[i];
+        phase_calls[i] += in_metrics.phase_calls[i];
+    }
+}
+
+string Search_metrics::to_json()
+// Returns the metrics as one JSON object on a single line; the phase times are in microseconds
+{
+    const char* phase_names[phase_count] = {"moves", "hashing", "heuristic", "goal_test"};
+    string json = "{\"expansions\":" + to_string(expansions)
+        + ",\"generations\":" + to_string(generations)
+        + ",\"duplicates\":" + to_string(duplicates)
+        + ",\"reparentings\":" + to_string(reparentings)
+        + ",\"deadlock_prunes\":{\"freeze\":" + to_string(prunes_freeze)
+        + ",\"corral\":" + to_string(prunes_corral)
+        + ",\"pattern\":" + to_string(prunes_pattern)
+        + ",\"unreachable\":" + to_string(prunes_unreachable) + "}"
+        + ",\"heap\":{\"push\":" + to_string(heap_pushes)
+        + ",\"pop\":" + to_string(heap_pops)
+        + ",\"decrease_key\":" + to_string(heap_decrease_keys)
+        + ",\"remove\":" + to_string(heap_removes) + "}"
+        + ",\"hda_messages\":" + to_string(hda_messages)
+        + ",\"phases\":{";
+    for (int i = 0; i < phase_count; i++) {
+        json += (i ? ",\"" : "\"") + string(phase_names[i]) + "\":{\"us\":" + to_string(phase_ns[i] / 1000)
+            + ",\"calls\":" + to_string(phase_calls[i]) + "}";
+    }
+    return json + "}}";
+}
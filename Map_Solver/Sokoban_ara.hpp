@@ -0,0 +1,134 @@
+//
+//  Sokoban_ara.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Weighted A* (WAstar) and anytime repairing A* (ARAstar) of Sokoban_features
+//  Included at the end of Sokoban_features.hpp, which declares the members
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Class include
+#include "Sokoban_features.hpp"
+
+// Weighted and anytime search methods *****************************************
+bool Sokoban_features::solve_ara(int max_search, bool anytime)
+// Weighted A* (f = g + w * h) and, when anytime is set, anytime repairing A* (ARA*) on top of it
+// The first search runs with the weight set by set_weight and returns a solution that costs at most weight times the optimum.
+// ARAstar then lowers the weight by ARA_WEIGHT_STEP and repairs the tree instead of searching from scratch: only the open nodes
+// and the nodes that got cheaper after their expansion (ara_inconsistent) are searched again. Every cheaper solution is put in
+// goal_ptr and reported until the weight is 1 (the solution is optimal), the time limit is reached or max_search nodes were expanded
+// Returns true if a solution was found
+{
+    long long time_end = currentTimeUs() + ara_time_limit;
+    search_weight = ara_weight;
+    ara_search = 0;
+    root = insert_child(nullptr); // Create tree root
+    hash_table_insert(root->zobrist_key, root, hash_table_ptr);
+    open_list_push(root);
+    while (ara_improve(max_search, time_end) and anytime and search_weight > 1) {
+        search_weight = max(search_weight - ARA_WEIGHT_STEP, 1.0);
+        ara_search++;
+        ara_reorder_open_list();
+    }
+    if (goal_ptr != nullptr and search_weight > 1)
+        print_info("Stopped with a solution within " + to_string(ara_bound()) + " of the optimal cost");
+    return goal_ptr != nullptr;
+}
+
+bool Sokoban_features::ara_improve(int max_search, long long time_end)
+// One weighted A* search of ARA*; expands the open nodes in f order while they can still lead to a cheaper goal than goal_ptr
+// Goals are tested when they are generated; a node with cost_to_node + heuristic (unweighted) above the cost of goal_ptr cannot
+// lead to a cheaper goal and is dropped from the open list. A cheaper goal_ptr is reported when the search stops
+// Returns false if the time limit or max_search was reached
+{
+    double goal_cost = (goal_ptr != nullptr) ? goal_ptr->cost_to_node : numeric_limits< double >::infinity();
+    double start_cost = goal_cost;
+    bool finished = true;
+    while (open_list.size() and f_value(open_list.front()) < goal_cost) {
+        feature_node* tmp_node = open_list_pop(); // node with the smallest f = cost_to_node + search_weight * heuristic
+        if (tmp_node->cost_to_node + tmp_node->heuristic >= goal_cost)
+            continue;
+        tmp_node->expanded_in = ara_search;
+        expanded_nodes++;
+        METRIC_EXPANSION();
+        memory_tick();
+
+        move_forward(tmp_node);
+        move_backward(tmp_node);
+        turn_right(tmp_node);
+        turn_left(tmp_node);
+
+        for (size_t i = 0; i < tmp_node->children.size(); i++) {
+            feature_node* tmp_child = tmp_node->children[i];
+            if (tmp_child->cost_to_node < goal_cost and goal_node(tmp_child)) {
+                goal_ptr = tmp_child;
+                goal_cost = tmp_child->cost_to_node;
+                if (tmp_child->heap_index >= 0)
+                    open_list_remove(tmp_child); // a goal is never expanded
+            }
+        }
+        if (expanded_nodes%10000 == 0) {
+            print_info("Visited " + to_string(expanded_nodes) + " and " + to_string(open_list.size()) + " nodes waiting (weight " + to_string(search_weight) + ")");
+        }
+        if (max_search <= expanded_nodes or currentTimeUs() >= time_end) {
+            finished = false;
+            break;
+        }
+    }
+    if (goal_cost < start_cost) {
+        double tmp_bound = ara_bound();
+        print_info("Solution with cost " + to_string(goal_cost) + " within " + to_string(tmp_bound) + " of the optimal cost (weight " + to_string(search_weight) + ")");
+        if (solution_callback)
+            solution_callback(goal_ptr, tmp_bound);
+    }
+    return finished;
+}
+
+double Sokoban_features::ara_bound()
+// Returns the factor the cost of goal_ptr is at most above the optimal cost; the cost of goal_ptr divided by the smallest
+// unweighted f of the nodes that are left to search (the open nodes and ara_inconsistent), but never more than the weight
+{
+    double min_f = goal_ptr->cost_to_node;
+    for (size_t i = 0; i < open_list.size(); i++)
+        min_f = min(min_f, open_list[i]->cost_to_node + open_list[i]->heuristic);
+    for (size_t i = 0; i < ara_inconsistent.size(); i++)
+        min_f = min(min_f, ara_inconsistent[i]->cost_to_node + ara_inconsistent[i]->heuristic);
+    if (min_f <= 0)
+        return search_weight;
+    return min(search_weight, goal_ptr->cost_to_node / min_f);
+}
+
+void Sokoban_features::ara_reorder_open_list()
+// Moves ara_inconsistent into the open list and rebuilds the heap for the new search_weight
+{
+    vector< feature_node* > tmp_nodes;
+    tmp_nodes.swap(open_list);
+    tmp_nodes.insert(tmp_nodes.end(), ara_inconsistent.begin(), ara_inconsistent.end());
+    ara_inconsistent.clear();
+    for (size_t i = 0; i < tmp_nodes.size(); i++)
+        tmp_nodes[i]->heap_index = -1;
+    for (size_t i = 0; i < tmp_nodes.size(); i++)
+        if (tmp_nodes[i]->heap_index < 0 and tmp_nodes[i] != goal_ptr)
+            open_list_push(tmp_nodes[i]);
+}
+
+void Sokoban_features::set_weight(double in_weight)
+// Sets the heuristic weight of the WAstar solver and of the first ARAstar search; weights below 1 are raised to 1
+{
+    ara_weight = max(in_weight, 1.0);
+}
+
+void Sokoban_features::set_time_limit(long long in_time_us)
+// Sets the time ARAstar keeps improving its solution
+{
+    ara_time_limit = in_time_us;
+}
+
+void Sokoban_features::set_solution_callback(function< void(feature_node*, double) > in_callback)
+// Sets the function ARAstar and WAstar call with goal_ptr and the bound of the solution every time a cheaper solution is found
+{
+    solution_callback = in_callback;
+}
@@ -0,0 +1,178 @@
+//
+//  Sokoban_bidirectional.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Bidirectional push search (BiPush) of Sokoban_features
+//  Included at the end of Sokoban_features.hpp, which declares the members
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Class include
+#include "Sokoban_features.hpp"
+
+// Bidirectional search methods ************************************************
+bool Sokoban_features::solve_bidirectional(int max_search)
+// A* over pushes from the start and A* over pulls from the solved configuration; the frontier with the fewer open nodes
+// is expanded next. Every state both searches reached (same boxes and worker region) is a plan; the cheapest one costs mu
+// and the search goes on until the smallest f of one of the frontiers is at least mu, so no cheaper plan is left (Pohl)
+// The backward search starts with the boxes on the goals and one root for every region the worker can end in
+// Returns false if max_search nodes were expanded first or a frontier ran empty before the searches met
+{
+    root = insert_child(nullptr); // Create tree root
+    root->set_worker(canonical_worker_cell(root), NORTH);
+    root->zobrist_key = zobrist_full_key(root);
+    hash_table_insert(root->zobrist_key, root, hash_table_ptr);
+    open_list_push(root);
+
+    init_start_distances();
+    bidirectional_switch();
+    feature_node solved_node{nullptr, 0};
+    solved_node.boxes = goal_cells.data();
+    for (int i = 0; i < box_count; i++) {
+        for (int dir = NORTH; dir <= WEST; dir++) {
+            // The worker made the last push so it is next to a box
+            int tmp_cell = goal_cells[i] + direction_step(dir);
+            if (!worker_free(&solved_node, tmp_cell))
+                continue;
+            solved_node.set_worker(reachable_region(&solved_node, tmp_cell), NORTH);
+            solved_node.zobrist_key = zobrist_full_key(&solved_node);
+            feature_node* tmp_node = &solved_node;
+            if (hash_table_exist(solved_node.zobrist_key, tmp_node, hash_table_ptr))
+                continue;
+            tmp_node = node_arena.create(nullptr, 0);
+            tmp_node->boxes = box_slot_alloc();
+            copy(goal_cells.begin(), goal_cells.end(), tmp_node->boxes);
+            tmp_node->worker_word = solved_node.worker_word;
+            tmp_node->zobrist_key = solved_node.zobrist_key;
+            tmp_node->cost_to_node = 0;
+            tmp_node->heuristic = calcualte_heuristic(tmp_node);
+            hash_table_insert(tmp_node->zobrist_key, tmp_node, hash_table_ptr);
+            open_list_push(tmp_node);
+        }
+    }
+    bidirectional_switch();
+    meeting_forward = nullptr;
+    meeting_backward = nullptr;
+    double best_meeting = MATCHING_UNREACHABLE; // mu
+
+    bool search_done = false;
+    while (open_list.size() and other_open_list.size()) {
+        if (max(f_value(open_list.front()), f_value(other_open_list.front())) >= best_meeting) {
+            search_done = true; // every plan through the open nodes of one search costs at least mu
+            break;
+        }
+        if (other_open_list.size() < open_list.size())
+            bidirectional_switch(); // expand the smaller frontier
+        feature_node* tmp_node = open_list_pop(); // node with the smallest f = cost_to_node + heuristic
+        closed_list.push_back(tmp_node);
+        METRIC_EXPANSION();
+        memory_tick();
+
+        // The node may have been met before with a larger cost (reparented since)
+        best_meeting = min(best_meeting, bidirectional_record_meeting(tmp_node));
+        if (bidirectional_backward)
+            generate_pulls(tmp_node);
+        else
+            generate_pushes(tmp_node);
+
+        for (size_t i = 0; i < tmp_node->children.size(); i++)
+            best_meeting = min(best_meeting, bidirectional_record_meeting(tmp_node->children.at(i)));
+        if (closed_list.size()%10000 == 0) {
+            print_info("Visited " + to_string(closed_list.size()) + " and " + to_string(open_list.size() + other_open_list.size()) + " nodes waiting (peeked at " + to_string(peeked_notes) + " nodes)");
+        }
+        if (max_search <= closed_list.size()) {
+            break;
+        }
+    }
+    if (bidirectional_backward)
+        bidirectional_switch(); // leave the forward search in place
+    // An empty frontier leaves no plan cheaper than mu either
+    if (meeting_forward == nullptr or (!search_done and max_search <= closed_list.size()))
+        return false;
+    goal_ptr = stitch_bidirectional(meeting_forward, meeting_backward);
+    return true;
+}
+
+void Sokoban_features::bidirectional_switch()
+// Swaps the open list, hash table and box distance table of the forward and the backward search so the push search
+// methods work on the other direction; the cached matching belongs to the old distances and is dropped
+{
+    open_list.swap(other_open_list);
+    swap(hash_table_ptr, other_hash_table_ptr);
+    goal_distance.swap(other_distance);
+    matching_boxes.assign(box_count, -1);
+    bidirectional_backward = !bidirectional_backward;
+}
+
+void Sokoban_features::init_start_distances()
+// Fills the distance table of the backward search like init_goal_distances; entry [box * cells + cell] is the number of
+// pulls that takes a box from the cell to the start cell of the box, ignoring the worker and the other boxes
+// A pull moves a box from x to x+step with the worker going from x+step to x+2*step, so both cells have to be floor
+{
+    int cells = map->get_cells();
+    other_distance.assign(box_count * cells, MATCHING_UNREACHABLE);
+    for (int j = 0; j < box_count; j++) {
+        int* tmp_distance = &other_distance[j * cells];
+        vector< int > distance_queue(1, root->boxes[j]);
+        tmp_distance[root->boxes[j]] = 0;
+        for (size_t q = 0; q < distance_queue.size(); q++) {
+            int tmp_cell = distance_queue[q];
+            for (int dir = NORTH; dir <= WEST; dir++) {
+                int step = direction_step(dir);
+                int from_cell = tmp_cell - step;
+                if ((map->cell_flags(from_cell) & CELL_WALL) or (map->cell_flags(tmp_cell + step) & CELL_WALL)
+                    or tmp_distance[from_cell] != MATCHING_UNREACHABLE)
+                    continue;
+                tmp_distance[from_cell] = tmp_distance[tmp_cell] + 1;
+                distance_queue.push_back(from_cell);
+            }
+        }
+    }
+}
+
+Sokoban_features::feature_node* Sokoban_features::bidirectional_meeting(feature_node* in_node)
+// Returns the node of the other search with the same boxes and canonical worker cell as in_node or the nullptr
+{
+    feature_node* tmp_node = in_node;
+    if (hash_table_exist(in_node->zobrist_key, tmp_node, other_hash_table_ptr))
+        return tmp_node;
+    return nullptr;
+}
+
+double Sokoban_features::bidirectional_record_meeting(feature_node* in_node)
+// Keeps in_node and its node of the other search as the best meeting if the plan through them is the cheapest so far
+// Returns the cost of the plan through in_node or MATCHING_UNREACHABLE if the other search has not reached the state
+{
+    feature_node* meeting_node = bidirectional_meeting(in_node);
+    if (meeting_node == nullptr)
+        return MATCHING_UNREACHABLE;
+    double tmp_cost = in_node->cost_to_node + meeting_node->cost_to_node;
+    if (meeting_forward == nullptr or tmp_cost < meeting_forward->cost_to_node + meeting_backward->cost_to_node) {
+        meeting_forward = bidirectional_backward ? meeting_node : in_node;
+        meeting_backward = bidirectional_backward ? in_node : meeting_node;
+    }
+    return tmp_cost;
+}
+
+Sokoban_features::feature_node* Sokoban_features::stitch_bidirectional(feature_node* forward_node, feature_node* backward_node)
+// Continues the push chain ending in forward_node with copies of the backward nodes from backward_node to its root
+// Read from the meeting state to the solved configuration the pulls are pushes, so the result is one chain of push nodes
+// that expand_push_path turns into single steps
+{
+    feature_node* push_node = forward_node;
+    for (feature_node* tmp_node = backward_node->parent; tmp_node != nullptr; tmp_node = tmp_node->parent) {
+        feature_node* tmp_node_child = node_arena.create(push_node, push_node->depth+1);
+        tmp_node_child->boxes = box_slot_alloc();
+        copy(tmp_node->boxes, tmp_node->boxes + box_count, tmp_node_child->boxes);
+        tmp_node_child->worker_word = tmp_node->worker_word;
+        tmp_node_child->zobrist_key = tmp_node->zobrist_key;
+        tmp_node_child->cost_to_node = push_node->cost_to_node + approach_cost;
+        tmp_node_child->heuristic = 0;
+        add_child_link(push_node, tmp_node_child, approach_cost);
+        push_node = tmp_node_child;
+    }
+    return expand_push_path(push_node);
+}
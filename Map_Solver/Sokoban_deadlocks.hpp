@@ -0,0 +1,257 @@
+//
+//  Sokoban_deadlocks.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Deadlock tests of Sokoban_features; freeze deadlocks, corral deadlocks and the learned deadlock patterns (see Deadlock_patterns.hpp)
+//  Included at the end of Sokoban_features.hpp, which declares the members
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Class include
+#include "Sokoban_features.hpp"
+
+// Deadlock methods ************************************************************
+bool Sokoban_features::freeze_deadlock(feature_node* in_node, int box_cell)
+// Tests if the box just pushed onto box_cell froze a group of boxes of which at least one is not on a goal
+// A frozen box can neither be pushed horizontally nor vertically, so such a state can never be solved
+{
+    if (box_frozen(in_node, box_cell) != 2)
+        return false;
+    METRIC_COUNT(prunes_freeze);
+    return true;
+}
+
+int Sokoban_features::box_frozen(feature_node* in_node, int box_cell)
+// Returns 0 if the box can still move, 1 if it is frozen in a group with boxes on goals only and 2 if a box of the group is off a goal
+// The box is treated as a wall while its neighbours are tested so two boxes blocking each other are found
+{
+    freeze_wall[box_cell] = true;
+    int horizontal = axis_frozen(in_node, box_cell, EAST);
+    int vertical = horizontal ? axis_frozen(in_node, box_cell, NORTH) : 0;
+    freeze_wall[box_cell] = false;
+    if (!horizontal or !vertical)
+        return 0;
+    if (!(map->cell_flags(box_cell) & CELL_GOAL))
+        return 2;
+    return max(horizontal, vertical);
+}
+
+int Sokoban_features::axis_frozen(feature_node* in_node, int box_cell, int in_dir)
+// Returns 0 if the box can be pushed along the axis of the direction; otherwise 1, or 2 if it is blocked by a frozen group with a box off a goal
+{
+    int step = direction_step(in_dir);
+    unsigned char flags1 = map->cell_flags(box_cell + step);
+    unsigned char flags2 = map->cell_flags(box_cell - step);
+    if ((flags1 & CELL_WALL) or (flags2 & CELL_WALL))
+        return 1;
+    if ((flags1 & CELL_BOX_DEAD) and (flags2 & CELL_BOX_DEAD))
+        return 1;
+    if (freeze_wall[box_cell + step] or freeze_wall[box_cell - step])
+        return 1;
+    int frozen = 0;
+    if (box_at(in_node, box_cell + step))
+        frozen = box_frozen(in_node, box_cell + step);
+    if (!frozen and box_at(in_node, box_cell - step))
+        frozen = box_frozen(in_node, box_cell - step);
+    return frozen;
+}
+
+bool Sokoban_features::corral_deadlock(feature_node* in_node, int box_cell, int worker_cell)
+// Tests if the push onto box_cell closed a corral, an area next to the box the worker cannot reach, that can never be resolved
+// Uses the worker region of the last reachable_region call which must be made for the node and worker_cell
+// The boxes of the corral are searched on their own with all other boxes removed; removing boxes never makes a problem harder
+// so if the corral boxes can neither all reach goals nor let the worker into the corral the state is a deadlock
+{
+    int start_cell = -1;
+    for (int dir = NORTH; dir <= WEST; dir++) {
+        int tmp_cell = box_cell + direction_step(dir);
+        if (!(map->cell_flags(tmp_cell) & CELL_WALL) and !box_at(in_node, tmp_cell) and !cell_reachable(tmp_cell)) {
+            start_cell = tmp_cell;
+            break;
+        }
+    }
+    if (start_cell < 0)
+        return false; // the push did not close anything next to the box
+
+    // The corral is every cell the worker cannot reach connected to start_cell; its border is made of walls and boxes only
+    corral_stamp_counter++;
+    corral_cells.clear();
+    corral_boxes.clear();
+    vector< int > corral_queue(1, start_cell);
+    corral_stamp[start_cell] = corral_stamp_counter;
+    bool boxes_on_goals = true;
+    for (size_t q = 0; q < corral_queue.size(); q++) {
+        int tmp_cell = corral_queue[q];
+        if (box_at(in_node, tmp_cell)) {
+            corral_boxes.push_back(tmp_cell);
+            if (!(map->cell_flags(tmp_cell) & CELL_GOAL))
+                boxes_on_goals = false;
+        } else
+            corral_cells.push_back(tmp_cell);
+        for (int dir = NORTH; dir <= WEST; dir++) {
+            int next_cell = tmp_cell + direction_step(dir);
+            if (!(map->cell_flags(next_cell) & CELL_WALL) and !cell_reachable(next_cell) and corral_stamp[next_cell] != corral_stamp_counter) {
+                corral_stamp[next_cell] = corral_stamp_counter;
+                corral_queue.push_back(next_cell);
+            }
+        }
+    }
+    if (boxes_on_goals)
+        return false;
+    sort(corral_boxes.begin(), corral_boxes.end());
+
+    vector< int > cache_key = corral_boxes;
+    cache_key.push_back(corral_region(corral_boxes, worker_cell));
+    auto cached = corral_cache.find(cache_key);
+    if (cached != corral_cache.end()) {
+        if (cached->second)
+            METRIC_COUNT(prunes_corral);
+        return cached->second;
+    }
+    bool deadlocked = corral_search(corral_boxes, worker_cell);
+    if (corral_cache.size() == CORRAL_CACHE_MAX)
+        corral_cache.clear(); // keeps the memory bounded; the cache is only a shortcut
+    corral_cache[cache_key] = deadlocked;
+    if (deadlocked) {
+        METRIC_COUNT(prunes_corral);
+        learn_deadlock_pattern(worker_cell);
+    }
+    return deadlocked;
+}
+
+void Sokoban_features::learn_deadlock_pattern(int worker_cell)
+// Stores the corral just proven deadlocked as a pattern if the corral boxes and every cell the worker cannot reach
+// with only those boxes on the map fit in one window; then the worker being outside the corral cells of the window
+// means it is in the region the proof was made for
+{
+    corral_region(corral_boxes, worker_cell);
+    vector< int > unreachable_cells;
+    for (int i = 0; i < map->get_cells(); i++)
+        if (floor_bits.test(i) and !corral_reach.test(i) and !binary_search(corral_boxes.begin(), corral_boxes.end(), i))
+            unreachable_cells.push_back(i);
+    deadlock_patterns.learn(corral_boxes, unreachable_cells);
+}
+
+bool Sokoban_features::pattern_deadlock(feature_node* in_node, int box_cell, int worker_cell)
+// Tests the learned patterns of every window containing the box just pushed onto box_cell; the worker stands on worker_cell
+{
+    if (!deadlock_patterns.match(in_node->boxes, box_count, box_cell, worker_cell))
+        return false;
+    METRIC_COUNT(prunes_pattern);
+    return true;
+}
+
+size_t Sokoban_features::get_deadlock_pattern_count()
+// Returns the number of learned deadlock patterns
+{
+    return deadlock_patterns.size();
+}
+
+void Sokoban_features::set_pattern_file(bool in_use)
+// Turns the pattern file of the map on or off (off by default, so benchmarks and tests start from the same patterns);
+// when on, solve starts with the patterns learned by earlier runs on the map and saves the ones it learns
+{
+    use_pattern_file = in_use;
+}
+
+bool Sokoban_features::push_splits_area(feature_node* in_node, int box_cell, int worker_cell)
+// Local test if the box may have closed a corral; false when every free side of the box connects to the worker
+// through the free cells of the ring of eight cells around the box, so no full reachability is needed
+{
+    int ring[8];
+    int north = direction_step(NORTH);
+    int east = direction_step(EAST);
+    ring[0] = box_cell + north;
+    ring[1] = box_cell + north + east;
+    ring[2] = box_cell + east;
+    ring[3] = box_cell - north + east;
+    ring[4] = box_cell - north;
+    ring[5] = box_cell - north - east;
+    ring[6] = box_cell - east;
+    ring[7] = box_cell + north - east;
+    bool ring_free[8];
+    bool ring_connected[8];
+    int worker_index = 0;
+    for (int i = 0; i < 8; i++) {
+        ring_free[i] = !(map->cell_flags(ring[i]) & CELL_WALL) and !box_at(in_node, ring[i]);
+        ring_connected[i] = false;
+        if (ring[i] == worker_cell)
+            worker_index = i;
+    }
+    ring_connected[worker_index] = true;
+    for (int i = 1; i < 8 and ring_free[(worker_index + i) % 8]; i++)
+        ring_connected[(worker_index + i) % 8] = true;
+    for (int i = 1; i < 8 and ring_free[(worker_index + 8 - i) % 8]; i++)
+        ring_connected[(worker_index + 8 - i) % 8] = true;
+    for (int i = 0; i < 8; i += 2)
+        if (ring_free[i] and !ring_connected[i])
+            return true;
+    return false;
+}
+
+int Sokoban_features::corral_region(vector< int > &in_boxes, int worker_cell)
+// Floods corral_reach with the cells the worker reaches when only in_boxes are on the map; returns the canonical cell
+{
+    corral_free.assign(floor_bits);
+    for (size_t i = 0; i < in_boxes.size(); i++)
+        corral_free.reset(in_boxes[i]);
+    corral_reach.clear();
+    corral_reach.set(worker_cell);
+    corral_reach.flood(corral_free, direction_step(SOUTH));
+    return corral_reach.lowest();
+}
+
+bool Sokoban_features::corral_search(vector< int > &in_boxes, int worker_cell)
+// Breadth-first search over pushes of in_boxes only (sorted cells); the boxes may only be pushed onto cells that are not dead
+// Returns true if the search runs out of states without getting all boxes on goals or the worker into a corral cell
+// and false if it succeeds or gives up after CORRAL_MAX_STATES states
+{
+    vector< vector< int > > search_queue; // sorted boxes followed by the canonical worker cell
+    set< vector< int > > search_seen;
+    search_queue.push_back(in_boxes);
+    search_queue.back().push_back(corral_region(in_boxes, worker_cell));
+    search_seen.insert(search_queue.back());
+    int boxes = in_boxes.size();
+    for (size_t q = 0; q < search_queue.size(); q++) {
+        vector< int > tmp_state = search_queue[q];
+        vector< int > tmp_boxes(tmp_state.begin(), tmp_state.begin() + boxes); // without the worker cell at the end
+        corral_region(tmp_boxes, tmp_state[boxes]);
+        bool boxes_on_goals = true;
+        for (int i = 0; i < boxes; i++)
+            if (!(map->cell_flags(tmp_state[i]) & CELL_GOAL))
+                boxes_on_goals = false;
+        if (boxes_on_goals)
+            return false;
+        for (size_t i = 0; i < corral_cells.size(); i++)
+            if (corral_reach.test(corral_cells[i]))
+                return false; // the corral is open
+
+        vector< int > pushes; // box index and step pairs
+        for (int i = 0; i < boxes; i++) {
+            for (int dir = NORTH; dir <= WEST; dir++) {
+                int step = direction_step(dir);
+                if (corral_reach.test(tmp_state[i] - step) and !(map->cell_flags(tmp_state[i] + step) & (CELL_WALL | CELL_BOX_DEAD))
+                    and !binary_search(tmp_state.begin(), tmp_state.begin() + boxes, tmp_state[i] + step)) {
+                    pushes.push_back(i);
+                    pushes.push_back(step);
+                }
+            }
+        }
+        for (size_t p = 0; p < pushes.size(); p += 2) {
+            vector< int > new_state(tmp_state.begin(), tmp_state.begin() + boxes);
+            int old_cell = new_state[pushes[p]];
+            new_state[pushes[p]] += pushes[p+1];
+            sort(new_state.begin(), new_state.end());
+            new_state.push_back(corral_region(new_state, old_cell));
+            if (search_seen.insert(new_state).second) {
+                if (search_seen.size() > CORRAL_MAX_STATES)
+                    return false;
+                search_queue.push_back(new_state);
+            }
+        }
+    }
+    return true;
+}
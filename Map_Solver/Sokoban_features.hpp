@@ -9,14 +9,30 @@
 #pragma once
 
 // Library include
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <fstream>
 #include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <random>
+#include <thread>
 
 // Class include
 #include "Map.hpp" // Uses map and therefore needs to be included
+#include "Hash_table.hpp"
+#include "Node_arena.hpp"
+#include "Bitboard.hpp"
+#include "Mpsc_queue.hpp"
+#include "Search_metrics.hpp"
+#include "Deadlock_patterns.hpp"
 #include <time.h>       /* time */
 #include <sys/time.h>       /* time */
+#include <sys/resource.h>   /* peak resident set size */
 
 // Defines
 #define     NORTH   1 // NOTE: this goes opposite the y-axis
@@ -32,6 +48,47 @@
 #define     deploy      5
 #define     approach    6
 
+// Compact state
+#define     BOX_CHUNK_SLOTS  4096 // box slots allocated at a time
+
+// Memory accounting
+#define     MEMORY_SAMPLE_EXPANSIONS  1024 // expansions between two samples of the memory high-water mark
+
+// Deadlocks
+#define     CORRAL_MAX_STATES  2000 // states of the corral sub-search before the corral is given up as unknown
+#define     CORRAL_CACHE_MAX   100000 // corral results kept before the cache is emptied
+
+// Iterative deepening (IDAstar)
+#define     IDA_DEFAULT_TABLE_ENTRIES  (1 << 16) // transposition table entries when no size is set
+#define     IDA_MAX_CHILDREN   4 // forward, backward, right and left
+
+// Memory bounded search (SMAstar)
+#define     SMA_DEFAULT_BUDGET  (256UL << 20) // bytes for the nodes when no budget is set
+#define     SMA_MIN_NODES       1000 // nodes kept whatever the budget is
+#define     SMA_EVICT_TARGET    0.9 // fraction of the budget the nodes are brought down to when it is exceeded
+
+// Weighted and anytime search (WAstar and ARAstar)
+#define     ARA_DEFAULT_WEIGHT      3.0 // heuristic weight of WAstar and of the first ARAstar search
+#define     ARA_WEIGHT_STEP         0.5 // ARAstar lowers the weight by this after every search until it is 1
+#define     ARA_DEFAULT_TIME_LIMIT  10000000 // us ARAstar keeps improving the solution
+
+// Parallel search (HDA)
+#define     HDA_BATCH_MESSAGES    64 // children sent to another worker in one queue element
+#define     HDA_FLUSH_EXPANSIONS  16 // expansions after which the partly filled batches are sent anyway
+#define     HDA_COUNT_EXPANSIONS  256 // expansions added to the shared counter (for max_search) at a time
+
+// Metrics (compiled in with -DSEARCH_METRICS, see Search_metrics.hpp)
+#define     METRICS_DEFAULT_FILE      "search_metrics.json" // one JSON object per line; truncated when a search starts
+#define     METRICS_CHECK_EXPANSIONS  1024 // expansions between two looks at the clock for the interval dumps
+#ifdef SEARCH_METRICS
+#define     METRIC_EXPANSION()  metrics_expansion()
+#else
+#define     METRIC_EXPANSION()  ((void)0)
+#endif
+
+// Heuristic
+#define     MATCHING_UNREACHABLE  100000 // box to goal distance of a box that cannot reach the goal
+
 // Moves cost_to_node
 #define     forward_cost     1
 #define     backward_cost    2
@@ -49,16 +106,22 @@ public:
 	// feature_node
     struct feature_node
     {
-        // Sokoban parameters
-        vector< point2D >   boxes; // vector for holding the different boxes
-        vector< int >       box_goal_ref;
-        point2D             worker_pos;
-        int                 worker_dir;
+        // Sokoban parameters (compact state)
+        unsigned int        worker_word; // worker cell index << 2 | (worker_dir-1)
+        cell_t*             boxes;  // sorted box cell indices; a slot of box_count entries owned by Sokoban_features
+
+        int worker_cell() { return worker_word >> 2; }
+        int worker_dir() { return (worker_word & 3) + 1; }
+        void set_worker(int in_cell, int in_dir) { worker_word = (in_cell << 2) | (in_dir-1); }
 
         // Tree parameters
 		int depth;
         double heuristic;
         double cost_to_node;
+        int heap_index = -1; // position in the A* open list heap; -1 when not in the open list
+        int expanded_in = -1; // ARAstar search that last expanded the node
+        double backed_f = -1; // SMAstar: smallest f of the forgotten children, orders the heap instead of f; -1 if none
+        unsigned long zobrist_key; // incrementally updated hash of boxes, worker_pos and worker_dir
 
         feature_node* parent = nullptr;
 		vector< feature_node* > children; // vector for holding the children
@@ -67,12 +130,19 @@ public:
 		feature_node(feature_node* in_parent, int in_depth)
         : parent{ in_parent }, depth{ in_depth } { }
     };
-    struct hash_node {
-        unsigned long hash_value;
-        feature_node* ref_node;
+    Hash_table< feature_node > hash_table;
+    Hash_table< feature_node >* hash_table_ptr = &hash_table;
+
+    // Bytes held by the search structures; allocated capacity, so a structure that grew and shrank still counts its peak
+    struct memory_usage {
+        size_t nodes = 0; // node slots of the arena and the box slots of the nodes
+        size_t children = 0; // children and children_edge_cost vectors of the nodes
+        size_t open_list = 0; // with the open list of the backward search
+        size_t closed_list = 0;
+        size_t hash_table = 0; // with the hash table of the backward search and the IDAstar transposition table
+
+        size_t total() { return nodes + children + open_list + closed_list + hash_table; }
     };
-    vector< hash_node > hash_table;
-    vector< hash_node >* hash_table_ptr = &hash_table;
 
 	// Constructor, overload constructor, and destructor
 	Sokoban_features();
@@ -84,22 +154,29 @@ public:
 	// Public Methods
     long long currentTimeUs();
 
+    point2D get_worker_pos(feature_node* in_node);
+    vector< point2D > get_boxes(feature_node* in_node);
+    int  get_box_count();
+
     feature_node* get_root_ptr();
     feature_node* get_goal_node_ptr();
 	feature_node* insert_child(feature_node* parent_node);
 
     void print_debug(const string& in_string);
     void print_info(const string& in_string);
+    void set_verbose(bool in_verbose);
 	void print_node(feature_node* in_node);
 	bool solve(int solver_type, int max_search);
     int  point_type(feature_node* in_node, point2D &inPoint, int map_type);
 	int  point_type(feature_node* in_node, int in_x, int in_y, int map_type);
+    int  point_type(feature_node* in_node, int in_cell, int map_type);
     double calcualte_heuristic(feature_node* in_node);
     double calculate_euclidian_distance(point2D &inPoint1, point2D &inPoint2);
     int calculate_taxicab_distance(point2D &inPoint1, point2D &inPoint2);
-    void update_nearest_goals(feature_node* in_node);
     unsigned long hash_node_to_key(feature_node* in_node);
+    unsigned long zobrist_full_key(feature_node* in_node);
     bool nodes_match(feature_node* in_node1, feature_node* in_node2);
+    static bool states_match(void* in_features, feature_node* in_node1, feature_node* in_node2);
     bool update_parent_node(feature_node* &in_node_child, feature_node* in_node_new_parent);
 	void print_branch_up(feature_node* in_node);
 	bool remove_node(feature_node* &child);
@@ -111,20 +188,69 @@ public:
 	bool goal_node(feature_node* in_node);
     bool goal_box(point2D in_box);
 	bool move_box(feature_node* in_node, int in_x, int in_y, int offset_x, int offset_y);
+    bool move_box(feature_node* in_node, int old_cell, int new_cell);
+    bool freeze_deadlock(feature_node* in_node, int box_cell);
+    bool corral_deadlock(feature_node* in_node, int box_cell, int worker_cell);
+    bool pattern_deadlock(feature_node* in_node, int box_cell, int worker_cell);
+    size_t get_deadlock_pattern_count();
+    void set_pattern_file(bool in_use);
+    bool box_at(feature_node* in_node, int in_cell);
     bool move_forward(feature_node* in_node);
     bool move_backward(feature_node* in_node);
 	bool turn_right(feature_node* in_node);
 	bool turn_left(feature_node* in_node);
+    void reparent_node(feature_node* in_node, feature_node* new_parent, double new_cost);
+    void reopen_node(feature_node* in_node);
+
+    // Push-level search methods
+    int  reachable_region(feature_node* in_node, int start_cell);
+    bool cell_reachable(int in_cell);
+    int  canonical_worker_cell(feature_node* in_node);
+    bool generate_pushes(feature_node* in_node);
+    bool generate_pulls(feature_node* in_node);
+    feature_node* expand_push_path(feature_node* push_goal);
+
     int  get_open_list_size();
     int  get_closed_list_size();
 
+    // Iterative deepening search methods
+    void set_ida_table_entries(size_t in_entries);
+
+    // Memory bounded search methods
+    void set_memory_budget(size_t in_bytes);
+
+    // Weighted and anytime search methods
+    void set_weight(double in_weight);
+    void set_time_limit(long long in_time_us);
+    void set_solution_callback(function< void(feature_node*, double) > in_callback);
+
+    // Memory accounting methods
+    memory_usage get_memory_usage();
+    memory_usage get_memory_peak();
+    static size_t get_peak_rss();
+
+    // Metrics methods
+    Search_metrics& get_metrics();
+    void set_metrics_file(const string& file_name);
+    void set_metrics_interval(long long in_interval_us);
+
+    // Parallel search methods
+    void set_thread_count(int in_threads);
+    int  get_thread_count();
+
+    // Open list methods
+    void open_list_push(feature_node* in_node);
+    feature_node* open_list_pop();
+    void open_list_decrease_key(feature_node* in_node);
+    void open_list_remove(feature_node* in_node);
+
 	// Hash table methods
-    bool hash_table_insert(feature_node* &in_node, vector< hash_node >* hash_ptr);
-    bool hash_table_insert(unsigned long in_hash_value, feature_node* &in_node, vector< hash_node >* hash_ptr);
-    bool hash_table_exist(feature_node* &in_node, vector< hash_node >* hash_ptr);
-    bool hash_table_exist(unsigned long in_hash_value, feature_node* &in_node, vector< hash_node >* hash_ptr);
-    bool hash_table_delete(feature_node* &in_node, vector< hash_node >* hash_ptr);
-    bool hash_table_delete(unsigned long in_hash_value, feature_node* &in_node, vector< hash_node >* hash_ptr);
+    bool hash_table_insert(feature_node* &in_node, Hash_table< feature_node >* hash_ptr);
+    bool hash_table_insert(unsigned long in_hash_value, feature_node* &in_node, Hash_table< feature_node >* hash_ptr);
+    bool hash_table_exist(feature_node* &in_node, Hash_table< feature_node >* hash_ptr);
+    bool hash_table_exist(unsigned long in_hash_value, feature_node* &in_node, Hash_table< feature_node >* hash_ptr);
+    bool hash_table_delete(feature_node* &in_node, Hash_table< feature_node >* hash_ptr);
+    bool hash_table_delete(unsigned long in_hash_value, feature_node* &in_node, Hash_table< feature_node >* hash_ptr);
 
 private:
 	// Private variables
@@ -133,17 +259,233 @@ private:
     Map* map;
 
     int chosen_graph_search;
+    bool verbose = true;
 
 	int peeked_notes = 0;
 
     vector< feature_node* > open_list; // Hold unvisited nodes
     vector< feature_node* > closed_list; // holds visited nodes
+    Node_arena< feature_node > node_arena; // owns all nodes of the tree; released with the solver
+
+    // Box storage; every node holds a slot of box_count sorted cell indices
+    int box_count = 0;
+    vector< cell_t* > box_chunks; // slabs of BOX_CHUNK_SLOTS slots
+    vector< cell_t* > box_slot_free; // released slots for reuse
+    size_t box_chunk_used = BOX_CHUNK_SLOTS; // slots handed out from the last chunk
+    vector< cell_t > goal_cells; // sorted goal cell indices
+    feature_node successor_node{nullptr, 0}; // successor being generated; only materialised if its state is new
+    vector< cell_t > successor_boxes; // box storage of successor_node
+
+    // Worker reachability bitboards; floor_bits are the cells that are not obstacles, free_bits the floor without the boxes
+    Bitboard floor_bits;
+    Bitboard free_bits;
+    Bitboard reach_bits; // result of the last reachable_region
+
+    // Freeze deadlock test; boxes on the recursion path of box_frozen are treated as walls
+    vector< bool > freeze_wall;
+
+    // Corral deadlock test; the corral cells are the cells whose stamp equals corral_stamp_counter
+    vector< int > corral_stamp;
+    int corral_stamp_counter = 0;
+    vector< int > corral_cells; // cells of the corral without boxes
+    vector< int > corral_boxes;
+    Bitboard corral_free; // floor without the corral boxes
+    Bitboard corral_reach;
+    std::map< vector< int >, bool > corral_cache; // corral boxes followed by the canonical worker cell; true if deadlocked
+
+    // Deadlock patterns learned by the corral test (see learn_deadlock_pattern)
+    Deadlock_patterns deadlock_patterns;
+    bool use_pattern_file = false; // solve loads and saves the patterns of the map (see set_pattern_file)
+
+    // Box to goal matching heuristic; goal_distance[goal * cells + cell] is the distance from the cell to the goal
+    // The matching of the last expanded node is cached (matching_*) and each child only repairs the row of its moved box
+    // Potentials and column assignments use the 1-based layout of the Hungarian algorithm; column 0 is a virtual column
+    vector< int > goal_distance;
+    vector< int > turn_distance; // [cell * 4 + side] fewest turns a worker facing the side needs to push a box on the cell to a goal
+    double expanded_worker_heuristic = 0; // worker_heuristic of the node being expanded; set by move_forward
+    vector< int > matching_boxes; // box cell of each row of the cached matching
+    vector< int > matching_u, matching_v, matching_p;
+    int matching_cost = 0;
+    vector< int > work_rows, work_u, work_v, work_p, work_way, work_minv;
+    vector< bool > work_used;
+
+    // Zobrist keys; one random key per (cell, box), per (cell, worker) and per worker_dir
+    vector< unsigned long > zobrist_box;
+    vector< unsigned long > zobrist_worker;
+    unsigned long zobrist_dir[5]; // indexed by NORTH, EAST, SOUTH, WEST
+
+    // Bidirectional search; the search not being expanded keeps its open list, hash table and box distance table in the
+    // other_* members (see bidirectional_switch). The backward search pulls the boxes away from the goals
+    bool bidirectional_backward = false; // true while the backward search is in the working members
+    vector< feature_node* > other_open_list;
+    Hash_table< feature_node > other_hash_table;
+    Hash_table< feature_node >* other_hash_table_ptr = &other_hash_table;
+    vector< int > other_distance;
+    feature_node* meeting_forward = nullptr; // cheapest state reached by both searches so far (forward and backward node)
+    feature_node* meeting_backward = nullptr;
+
+    // Iterative deepening A*; the path from the root to the current node is a stack of frames with the boxes of frame i
+    // at ida_path_boxes[i * box_count]. The children of frame i are generated at once into the child slots of frame i
+    struct ida_frame {
+        unsigned int worker_word;
+        unsigned long zobrist_key;
+        double cost_to_node;
+        double heuristic;
+        int children;
+        int next_child; // child to enter next; -1 before the frame has been expanded
+    };
+    struct ida_entry {
+        unsigned long key;
+        float cost_to_node; // smallest cost the state was reached with in the iteration (the costs are multiples of 0.5)
+        int iteration;
+#ifdef FULL_STATE_CHECK
+        unsigned int worker_word; // the boxes are in ida_table_boxes
+#endif
+    };
+    vector< ida_frame > ida_path;
+    vector< cell_t > ida_path_boxes;
+    vector< ida_frame > ida_children; // IDA_MAX_CHILDREN slots per frame
+    vector< cell_t > ida_children_boxes;
+    vector< ida_entry > ida_table; // direct mapped on the key; a new entry replaces the old one
+    size_t ida_table_entries = IDA_DEFAULT_TABLE_ENTRIES; // a power of two (see set_ida_table_entries)
+#ifdef FULL_STATE_CHECK
+    vector< cell_t > ida_table_boxes; // box_count cells per entry
+    feature_node ida_entry_node{nullptr, 0}; // state of a table entry for states_match
+#endif
+    feature_node ida_node{nullptr, 0}; // node on top of the path while it is expanded
+
+    // Memory bounded A*
+    size_t sma_budget = SMA_DEFAULT_BUDGET; // bytes
+
+    // Weighted and anytime A*; f = cost_to_node + search_weight * heuristic
+    double search_weight = 1;
+    double ara_weight = ARA_DEFAULT_WEIGHT; // weight of WAstar and of the first ARAstar search
+    long long ara_time_limit = ARA_DEFAULT_TIME_LIMIT; // us
+    int ara_search = 0; // number of the current ARAstar search (see feature_node::expanded_in)
+    vector< feature_node* > ara_inconsistent; // nodes that got cheaper after they were expanded in the current search
+    function< void(feature_node*, double) > solution_callback; // called with goal_ptr and its bound on every better solution
+
+    long expanded_nodes = 0; // expansions of the solvers without a closed list (IDAstar, SMAstar, WAstar and ARAstar)
+
+    // Memory accounting; children_bytes is kept up to date as the child vectors grow and nodes are destroyed
+    size_t children_bytes = 0;
+    memory_usage memory_peak; // high-water mark of every structure; sampled every MEMORY_SAMPLE_EXPANSIONS expansions
+    long memory_ticks = 0;
+
+    // Search metrics; only updated when compiled with SEARCH_METRICS
+    Search_metrics metrics;
+    string metrics_file = METRICS_DEFAULT_FILE;
+    long long metrics_interval = 0; // us between two dumps during the search; 0 only dumps at the end
+    long long metrics_start = 0;
+    long long metrics_last_dump = 0;
+
+    // Hash-distributed A*; every state is owned by the worker hda_owner picks from the key of its boxes and only that
+    // worker stores and expands it. Children owned by another worker are sent to it in batches through its inbox.
+    // The solver that starts the search holds the shared state and the workers; each worker is a Sokoban_features of its own
+    struct hda_message {
+        unsigned long zobrist_key;
+        feature_node* parent; // node of the sending worker; only followed once the search is over
+        double cost_to_node;
+        double heuristic;
+        unsigned int worker_word;
+        int depth;
+    };
+    struct hda_batch : mpsc_link {
+        int sender;
+        vector< hda_message > messages;
+        vector< cell_t > boxes; // box_count cells per message
+    };
+    struct hda_shared {
+        int threads = 1;
+        vector< Sokoban_features* > workers;
+        atomic< double > incumbent; // cost of the cheapest goal found so far
+        mutex goal_mutex; // guards goal_node_ptr and the updates of incumbent
+        feature_node* goal_node_ptr = nullptr;
+        atomic< long > pending; // messages not yet stored plus workers not idle; the search is over when it is zero
+        atomic< long > expanded;
+        long max_search = 0;
+        atomic< bool > done;
+        atomic< bool > exhausted; // max_search was reached
+    };
+    int hda_threads = 0; // workers of the next HDA search; 0 uses one per core
+    hda_shared hda_state; // used when this solver starts the search
+    hda_shared* hda = &hda_state;
+    int hda_id = 0;
+    bool hda_idle = false;
+    vector< Sokoban_features* > hda_workers; // owned by the solver that started the search
+    Mpsc_queue< hda_batch > hda_inbox;
+    Mpsc_queue< hda_batch > hda_pool; // empty batches handed back by the receivers
+    vector< hda_batch* > hda_outbox; // batch being filled for each receiver
+    vector< hda_batch* > hda_batches; // every batch allocated by this worker
 
 	// Private Methods
-    hash<string> str_hash; // define a sting hashing func
+    bool solve_search(int solver_type, int max_search);
+    void add_child_link(feature_node* parent_node, feature_node* child_node, double edge_cost);
+    size_t child_vector_bytes(feature_node* in_node);
+    void memory_tick();
+    void memory_sample();
+    void metrics_expansion();
+    void metrics_dump(bool final_dump);
+    void init_zobrist_keys();
+    void init_compact_state();
+    cell_t* box_slot_alloc();
+    void box_slot_release(cell_t* in_slot);
+    void init_goal_distances();
+    void init_turn_distances();
+    int  turn_steps(int in_side1, int in_side2);
+    int  box_heuristic(feature_node* in_node);
+    double worker_heuristic(feature_node* in_node);
+    double successor_heuristic(feature_node* in_node, bool boxes_moved);
+    void matching_augment(int in_row);
+    int  matching_solve();
+    int  matching_sum();
+    int  direction_step(int in_dir);
+    bool worker_free(feature_node* in_node, int in_cell);
+    bool box_free(feature_node* in_node, int in_cell);
+    int  box_frozen(feature_node* in_node, int box_cell);
+    int  axis_frozen(feature_node* in_node, int box_cell, int in_dir);
+    bool push_splits_area(feature_node* in_node, int box_cell, int worker_cell);
+    int  corral_region(vector< int > &in_boxes, int worker_cell);
+    void learn_deadlock_pattern(int worker_cell);
+    bool corral_search(vector< int > &in_boxes, int worker_cell);
+    bool plan_walk(feature_node* in_node, int start_cell, int start_dir, int target_cell, int target_dir, vector< int > &walk_states);
+    void begin_successor(feature_node* in_node);
+    void successor_move_worker(int in_cell);
+    void successor_turn(int in_dir);
+    bool add_successor(feature_node* in_node, double edge_cost, bool boxes_moved);
+    bool solve_bidirectional(int max_search);
+    void bidirectional_switch();
+    void init_start_distances();
+    feature_node* bidirectional_meeting(feature_node* in_node);
+    double bidirectional_record_meeting(feature_node* in_node);
+    feature_node* stitch_bidirectional(feature_node* forward_node, feature_node* backward_node);
+    bool solve_ida(int max_search);
+    bool ida_add_child(feature_node* in_node, double edge_cost, bool boxes_moved);
+    feature_node* ida_solution_path();
+    bool solve_sma(int max_search);
+    size_t sma_evict(size_t target_nodes);
+    bool solve_ara(int max_search, bool anytime);
+    bool ara_improve(int max_search, long long time_end);
+    double ara_bound();
+    void ara_reorder_open_list();
+    bool solve_hda(int max_search);
+    void hda_init_worker(Sokoban_features* in_owner, int in_id);
+    void hda_run();
+    int  hda_owner(feature_node* in_node);
+    bool hda_send(feature_node* in_node, double edge_cost, bool boxes_moved);
+    bool hda_insert(feature_node* parent_node, int in_depth, double in_cost, double in_heuristic);
+    bool hda_receive();
+    hda_batch* hda_new_batch();
+    void hda_flush(int in_receiver);
+    void hda_flush_all();
+    void hda_report_goal(feature_node* in_node);
+    double f_value(feature_node* in_node);
+    bool heap_less(feature_node* in_node1, feature_node* in_node2);
+    void heap_swap(int pos1, int pos2);
+    void heap_sift_up(int pos);
+    void heap_sift_down(int pos);
 };
 
-
 Sokoban_features::Sokoban_features()
 // Default constructor
 {
@@ -158,11 +500,23 @@ Sokoban_features::Sokoban_features(Map* map_ptr)
 	root = nullptr;
     goal_ptr = nullptr;
 	map = map_ptr;
+    init_compact_state();
+    init_zobrist_keys();
+#ifdef FULL_STATE_CHECK
+    hash_table.set_match_function(&Sokoban_features::states_match, this);
+    other_hash_table.set_match_function(&Sokoban_features::states_match, this);
+#endif
 }
 
 Sokoban_features::~Sokoban_features()
 {
-	// Do cleanup
+	// Do cleanup; the nodes are released by node_arena
+    for (size_t i = 0; i < hda_workers.size(); i++)
+        delete hda_workers[i];
+    for (size_t i = 0; i < hda_batches.size(); i++)
+        delete hda_batches[i];
+    for (size_t i = 0; i < box_chunks.size(); i++)
+        delete[] box_chunks[i];
 }
 
 long long Sokoban_features::currentTimeUs()
@@ -173,6 +527,75 @@ long long Sokoban_features::currentTimeUs()
     return (long long)current.tv_sec * 1000000L + current.tv_usec;
 }
 
+point2D Sokoban_features::get_worker_pos(feature_node* in_node)
+// Returns the worker position of a node
+{
+    point2D tmp_point;
+    tmp_point.x = map->cell_x(in_node->worker_cell());
+    tmp_point.y = map->cell_y(in_node->worker_cell());
+    return tmp_point;
+}
+
+vector< point2D > Sokoban_features::get_boxes(feature_node* in_node)
+// Returns the box positions of a node
+{
+    vector< point2D > tmp_boxes(box_count);
+    for (int i = 0; i < box_count; i++) {
+        tmp_boxes[i].x = map->cell_x(in_node->boxes[i]);
+        tmp_boxes[i].y = map->cell_y(in_node->boxes[i]);
+    }
+    return tmp_boxes;
+}
+
+int  Sokoban_features::get_box_count()
+// Returns the number of boxes in every node
+{
+    return box_count;
+}
+
+void Sokoban_features::init_compact_state()
+// Prepares the compact state storage for the loaded map
+{
+    vector< point2D > goals = map->get_goals();
+    box_count = goals.size();
+    for (size_t i = 0; i < goals.size(); i++)
+        goal_cells.push_back(map->cell_index(goals[i].x, goals[i].y));
+    sort(goal_cells.begin(), goal_cells.end());
+    successor_boxes.resize(box_count);
+    floor_bits.resize(map->get_cells());
+    free_bits.resize(map->get_cells());
+    reach_bits.resize(map->get_cells());
+    for (int i = 0; i < map->get_cells(); i++)
+        if (!(map->cell_flags(i) & CELL_WALL))
+            floor_bits.set(i);
+    freeze_wall.assign(map->get_cells(), false);
+    corral_stamp.assign(map->get_cells(), 0);
+    corral_free.resize(map->get_cells());
+    corral_reach.resize(map->get_cells());
+    deadlock_patterns.set_map(map);
+}
+
+cell_t* Sokoban_features::box_slot_alloc()
+// Hands out a slot for the boxes of one node; slots are taken from the free list first and otherwise from the current chunk
+{
+    if (box_slot_free.size()) {
+        cell_t* tmp_slot = box_slot_free.back();
+        box_slot_free.pop_back();
+        return tmp_slot;
+    }
+    if (box_chunk_used == BOX_CHUNK_SLOTS) {
+        box_chunks.push_back(new cell_t[BOX_CHUNK_SLOTS * max(box_count, 1)]);
+        box_chunk_used = 0;
+    }
+    return box_chunks.back() + (box_chunk_used++) * box_count;
+}
+
+void Sokoban_features::box_slot_release(cell_t* in_slot)
+// Returns a box slot so it can be reused by a later node
+{
+    box_slot_free.push_back(in_slot);
+}
+
 Sokoban_features::feature_node* Sokoban_features::get_root_ptr()
 // Returns the root node (ptr)
 {
@@ -186,48 +609,45 @@ Sokoban_features::feature_node* Sokoban_features::get_goal_node_ptr()
 
 Sokoban_features::feature_node* Sokoban_features::insert_child(feature_node* parent_node)
 // Input: can either be the nullptr for creating the root of the tree or a pointer to the parent
+// A child gets the state of the pending successor (see begin_successor); add_successor sets its cost and heuristic
 // Output: Pointer to the created node / child
 {
-	peeked_notes++;
     feature_node* temp_node = nullptr;
     if (parent_node == nullptr) {
         if (root == nullptr) {
-            temp_node = new Sokoban_features::feature_node{nullptr,0};
-			temp_node->boxes = map->get_boxes();
-            for (size_t i = 0; i < temp_node->boxes.size(); i++) {
-                temp_node->box_goal_ref.push_back(i);
+            temp_node = node_arena.create(nullptr, 0);
+            temp_node->boxes = box_slot_alloc();
+            vector< point2D > tmp_boxes = map->get_boxes();
+            for (int i = 0; i < box_count; i++) {
+                temp_node->boxes[i] = map->cell_index(tmp_boxes[i].x, tmp_boxes[i].y);
             }
-            if (chosen_graph_search == Astar) {
-                update_nearest_goals(temp_node);
+            sort(temp_node->boxes, temp_node->boxes + box_count);
+            point2D tmp_worker = map->get_worker();
+			temp_node->set_worker(map->cell_index(tmp_worker.x, tmp_worker.y), NORTH);
+            if (chosen_graph_search != BF) {
                 temp_node->heuristic = calcualte_heuristic(temp_node);
             } else
                 temp_node->heuristic = 0; // No heuristic for BF
-			temp_node->worker_pos = map->get_worker();
-			temp_node->worker_dir = NORTH;
             temp_node->cost_to_node = 0;
+            temp_node->zobrist_key = zobrist_full_key(temp_node);
 
             root = temp_node; // Set root as temp node after relevant info is saved from Map object
         } else
             print_info("Trying to create new root in existing tree, please create a new feature tree and try again.");
     } else {
-        temp_node = new Sokoban_features::feature_node{parent_node,parent_node->depth+1};
-        // Save box information from parent
-		temp_node->boxes = parent_node->boxes;
-        temp_node->box_goal_ref = parent_node->box_goal_ref;
-        // Save worker information from parent
-		temp_node->worker_pos = parent_node->worker_pos;
-		temp_node->worker_dir = parent_node->worker_dir;
+        temp_node = node_arena.create(parent_node, parent_node->depth+1);
+        // Save box information from the successor
+        temp_node->boxes = box_slot_alloc();
+        copy(successor_node.boxes, successor_node.boxes + box_count, temp_node->boxes);
+        // Save worker information from the successor
+		temp_node->worker_word = successor_node.worker_word;
+        temp_node->zobrist_key = successor_node.zobrist_key;
         // Save stuff for searching
         temp_node->cost_to_node = parent_node->cost_to_node; // no movement yet so there is no added edge cost!
-        if (chosen_graph_search == Astar) {
-            update_nearest_goals(temp_node);
-            temp_node->heuristic = calcualte_heuristic(temp_node);
-        } else
-            temp_node->heuristic = 0; // No heuristic for BF
+        temp_node->heuristic = 0;
 
         // Add new node to parent!
-        parent_node->children.push_back(temp_node);
-        parent_node->children_edge_cost.push_back(0); // no movement yet so there is no edge cost!
+        add_child_link(parent_node, temp_node, 0); // no movement yet so there is no edge cost!
         // The node has no children at this stage
         // The node has no childrena and therefore no children edge cost
     }
@@ -244,7 +664,9 @@ bool Sokoban_features::remove_node(feature_node* &child)
 			parent_node->children_edge_cost.erase(parent_node->children_edge_cost.begin()+i);
 		}
 	}
-	delete child;
+    children_bytes -= child_vector_bytes(child);
+    box_slot_release(child->boxes);
+	node_arena.destroy(child);
 	child = nullptr;
 	return true;
 }
@@ -252,7 +674,9 @@ bool Sokoban_features::remove_node(feature_node* &child)
 bool Sokoban_features::remove_only_node(feature_node* &child)
 // Removes the node BUT NOT from the parent
 {
-	delete child;
+    children_bytes -= child_vector_bytes(child);
+    box_slot_release(child->boxes);
+	node_arena.destroy(child);
 	child = nullptr;
 	return true;
 }
@@ -280,8 +704,7 @@ bool Sokoban_features::add_node_to_parent(feature_node* &child, int pos)
         //parent_node->children_edge_cost.insert(parent_node->children.begin()+pos,0);
         // NOTE no Astar here, just adds the edge_cost 0
     } else {
-        parent_node->children.push_back(child);
-        parent_node->children_edge_cost.push_back(child->cost_to_node);
+        add_child_link(parent_node, child, child->cost_to_node);
     }
 	return true;
 }
@@ -315,21 +738,51 @@ bool Sokoban_features::update_node_cost(feature_node* &child, double node_cost)
 void Sokoban_features::print_node(feature_node* in_node)
 // Prints a node using the Map class
 {
-	map->print_map(in_node->worker_pos, in_node->boxes, false);
+    point2D tmp_worker = get_worker_pos(in_node);
+	map->print_map(tmp_worker, get_boxes(in_node), false);
 }
 
 bool Sokoban_features::solve(int solver_type, int max_search)
 // Solver
-// Input: BF or Astar (defines in common) and max search counter
+// Input: BF, Astar, Push, HDA, BiPush, IDAstar, SMAstar, WAstar or ARAstar (defines in common) and max search counter
 // Output: true if a solution has been found
+// With SEARCH_METRICS the metrics of the search are written to metrics_file when it is over (see set_metrics_interval)
+// The memory high-water mark is sampled once more at the end (see get_memory_peak)
+// With set_pattern_file the patterns of earlier runs are loaded before the search and the learned ones saved after it
+{
+#ifdef SEARCH_METRICS
+    metrics.reset();
+    metrics_start = metrics_last_dump = currentTimeUs();
+    ofstream(metrics_file, ios::trunc);
+    chosen_graph_search = solver_type;
+#endif
+    if (use_pattern_file and root == nullptr and deadlock_patterns.load())
+        print_info("Loaded " + to_string(deadlock_patterns.size()) + " deadlock patterns");
+    bool found_solution = solve_search(solver_type, max_search);
+    memory_sample();
+    if (use_pattern_file and deadlock_patterns.changed())
+        deadlock_patterns.save();
+#ifdef SEARCH_METRICS
+    metrics_dump(true);
+#endif
+    return found_solution;
+}
+
+bool Sokoban_features::solve_search(int solver_type, int max_search)
+// Runs the chosen solver; see solve
 {
     /* initialize random seed: */
     srand (time(NULL));
     long long time_stamp = currentTimeUs();
-    std::cout << "Time stamp is: " << time_stamp << std::endl;
-    std::cout << "Time stamp diff is: " << currentTimeUs() - time_stamp << std::endl;
+    if (verbose) {
+        std::cout << "Time stamp is: " << time_stamp << std::endl;
+        std::cout << "Time stamp diff is: " << currentTimeUs() - time_stamp << std::endl;
+    }
 
 	if (root == nullptr) {
+        if (solver_type != BF)
+            init_goal_distances(); // the push distance maps exist from here on
+
 		if (solver_type == BF) {
             chosen_graph_search = BF;
 			root = insert_child(nullptr); // Create tree root
@@ -339,6 +792,8 @@ bool Sokoban_features::solve(int solver_type, int max_search)
 				feature_node* tmp_node = open_list.front();
 				open_list.erase(open_list.begin());
                 closed_list.push_back(tmp_node);
+                METRIC_EXPANSION();
+                memory_tick();
                 // cout << "Parent" << endl;
                 //print_node(tmp_node);
 				move_forward(tmp_node);
@@ -354,7 +809,7 @@ bool Sokoban_features::solve(int solver_type, int max_search)
                         goal_ptr = tmp_node->children.at(i);
                         break_search = true;
                         branching /= closed_list.size();
-                        cout << "Average branching is " << branching << endl;
+                        print_info("Average branching is " + to_string(branching));
 						break;
 					}
 				}
@@ -370,21 +825,13 @@ bool Sokoban_features::solve(int solver_type, int max_search)
 		} else if (solver_type == Astar) {
             chosen_graph_search = Astar;
 			root = insert_child(nullptr); // Create tree root
-            open_list.push_back(root);
+            open_list_push(root);
             double branching = 0;
 			while (open_list.size()) {
-                int smallest_Astar_id = 0;
-                int smallest_Astar_value = open_list.at(0)->cost_to_node + open_list.at(0)->heuristic;
-                for (size_t i = 1; i < open_list.size(); i++) {
-                    if (open_list.at(i)->cost_to_node + open_list.at(i)->heuristic < smallest_Astar_value) {
-                        smallest_Astar_id = i;
-                    }
-                }
-                feature_node* tmp_node = open_list.at(smallest_Astar_id);
-                //cout << "Chose id " << smallest_Astar_id << " which has fscore " << open_list.at(smallest_Astar_id)->cost_to_node + open_list.at(smallest_Astar_id)->heuristic << endl;
-
-                open_list.erase(open_list.begin()+smallest_Astar_id);
+                feature_node* tmp_node = open_list_pop(); // node with the smallest f = cost_to_node + heuristic
                 closed_list.push_back(tmp_node);
+                METRIC_EXPANSION();
+                memory_tick();
 
                 move_forward(tmp_node);
                 move_backward(tmp_node); // saves some moves but adds a lot of nodes (a factor more)
@@ -399,7 +846,44 @@ bool Sokoban_features::solve(int solver_type, int max_search)
                         goal_ptr = tmp_node->children.at(i);
                         break_search = true;
                         branching /= closed_list.size();
-                        cout << "Average branching is " << branching << endl;
+                        print_info("Average branching is " + to_string(branching));
+						break;
+					}
+				}
+				if (break_search)
+					break;
+                if (closed_list.size()%10000 == 0) {
+                    print_info("Visited " + to_string(closed_list.size()) + " and " + to_string(open_list.size()) + " nodes waiting (peeked at " + to_string(peeked_notes) + " nodes)");
+                }
+                if (max_search <= closed_list.size()) {
+                    return false;
+                }
+            }
+		} else if (solver_type == Push) {
+            chosen_graph_search = Push;
+			root = insert_child(nullptr); // Create tree root
+            // Push nodes hold the canonical worker cell (the smallest cell index it can reach) and always face NORTH
+            root->set_worker(canonical_worker_cell(root), NORTH);
+            root->zobrist_key = zobrist_full_key(root);
+            hash_table_insert(root->zobrist_key, root, hash_table_ptr);
+            open_list_push(root);
+            double branching = 0;
+			while (open_list.size()) {
+                feature_node* tmp_node = open_list_pop(); // node with the smallest f = cost_to_node + heuristic
+                closed_list.push_back(tmp_node);
+                METRIC_EXPANSION();
+                memory_tick();
+
+                generate_pushes(tmp_node);
+
+                branching += tmp_node->children.size();
+				bool break_search = false;
+				for (size_t i = 0; i < tmp_node->children.size(); i++) {
+					if (goal_node(tmp_node->children.at(i))) {
+                        goal_ptr = expand_push_path(tmp_node->children.at(i));
+                        break_search = true;
+                        branching /= closed_list.size();
+                        print_info("Average branching is " + to_string(branching));
 						break;
 					}
 				}
@@ -412,10 +896,34 @@ bool Sokoban_features::solve(int solver_type, int max_search)
                     return false;
                 }
             }
+		} else if (solver_type == BiPush) {
+            chosen_graph_search = BiPush;
+            if (!solve_bidirectional(max_search))
+                return false;
+		} else if (solver_type == IDAstar) {
+            chosen_graph_search = IDAstar;
+            if (!solve_ida(max_search))
+                return false;
+		} else if (solver_type == SMAstar) {
+            chosen_graph_search = SMAstar;
+            if (!solve_sma(max_search))
+                return false;
+		} else if (solver_type == WAstar) {
+            chosen_graph_search = WAstar;
+            if (!solve_ara(max_search, false))
+                return false;
+		} else if (solver_type == ARAstar) {
+            chosen_graph_search = ARAstar;
+            if (!solve_ara(max_search, true))
+                return false;
+		} else if (solver_type == HDA) {
+            chosen_graph_search = HDA;
+            if (!solve_hda(max_search))
+                return false;
 		} else {
 			print_info("Unknown solver type, try again.");
 		}
-        if (open_list.size()) {
+        if (goal_ptr != nullptr) {
             return true;
         } else {
             return false;
@@ -431,103 +939,31 @@ bool Sokoban_features::move_forward(feature_node* in_node)
 // Adds the forwards move node to the open list if it does NOT exist.
 // If the node already exists the tree is manipulated if the new node has a smaller cost to node
 {
-    feature_node* tmp_node_child = insert_child(in_node);
-    int move_x = 0;
-    int move_y = 0;
-    int deadlock_test_x1 = 0;
-    int deadlock_test_x2 = 0;
-    int deadlock_test_y1 = 0;
-    int deadlock_test_y2 = 0;
-    if (tmp_node_child->worker_dir == NORTH) {
-        move_y = -1;
-        deadlock_test_x1 = -1;
-        deadlock_test_x2 = 1;
-        deadlock_test_y1 = -2;
-        deadlock_test_y2 = -2;
-    } else if (tmp_node_child->worker_dir == EAST) {
-        move_x = 1;
-        deadlock_test_x1 = 2;
-        deadlock_test_x2 = 2;
-        deadlock_test_y1 = -1;
-        deadlock_test_y2 = 1;
-    } else if (tmp_node_child->worker_dir == SOUTH) {
-        move_y = 1;
-        deadlock_test_x1 = 1;
-        deadlock_test_x2 = -1;
-        deadlock_test_y1 = 2;
-        deadlock_test_y2 = 2;
-    } else if (tmp_node_child->worker_dir == WEST) {
-        move_x = -1;
-        deadlock_test_x1 = -2;
-        deadlock_test_x2 = -2;
-        deadlock_test_y1 = 1;
-        deadlock_test_y2 = -1;
-    }
+    METRIC_TIME(phase_moves);
+    expanded_worker_heuristic = worker_heuristic(in_node);
+    int step = direction_step(in_node->worker_dir());
+    int front_cell = in_node->worker_cell() + step;
     // First test if there is free space to move forward
     // second test if there is a box in front and if there is test for freespace or goal in front of box
-    if (point_type(tmp_node_child, tmp_node_child->worker_pos.x + move_x, tmp_node_child->worker_pos.y + move_y, worker) == freespace
-	or point_type(tmp_node_child, tmp_node_child->worker_pos.x + move_x, tmp_node_child->worker_pos.y + move_y, worker) == goal) {
+    int front_type = point_type(in_node, front_cell, worker);
+    if (front_type == freespace or front_type == goal) {
         // MOVE FORWARD TO FREESPACE
-        //tmp_node_child->cost_to_node = tmp_node_child->cost_to_node + 1*forward_cost;
-        update_node_cost(tmp_node_child, 1*forward_cost);
-        tmp_node_child->worker_pos.x = tmp_node_child->worker_pos.x + move_x;
-        tmp_node_child->worker_pos.y = tmp_node_child->worker_pos.y + move_y;
-
-        feature_node* tmp_node_child_for_check = tmp_node_child;
-        if (hash_table_insert(tmp_node_child_for_check, hash_table_ptr)) {
-            open_list.push_back(tmp_node_child);
-            return true;
-        } else {
-            // Check if the returned
-            if (tmp_node_child->cost_to_node < tmp_node_child_for_check->cost_to_node) {
-                tmp_node_child_for_check->cost_to_node = tmp_node_child->cost_to_node;
-                remove_node_from_parent(tmp_node_child_for_check);
-                tmp_node_child_for_check->parent = tmp_node_child->parent;
-                //add_node_to_parent(tmp_node_child_for_check,0);
-                update_node_to_parent(tmp_node_child_for_check, tmp_node_child);
-                remove_only_node(tmp_node_child);
-                return true;
-            } else {
-                remove_node(tmp_node_child);
-                return false;
-            }
-        }
-        return false;
-    } else if (point_type(tmp_node_child, tmp_node_child->worker_pos.x + move_x, tmp_node_child->worker_pos.y + move_y, worker) == box
-                and (point_type(tmp_node_child, tmp_node_child->worker_pos.x + move_x*2, tmp_node_child->worker_pos.y + move_y*2, worker) == goal
-                    or point_type(tmp_node_child, tmp_node_child->worker_pos.x + move_x*2, tmp_node_child->worker_pos.y + move_y*2, box) == freespace) ) {
-
-        //tmp_node_child->cost_to_node = tmp_node_child->cost_to_node + approach_cost;
-        update_node_cost(tmp_node_child, 1*approach_cost);
+        begin_successor(in_node);
+        successor_move_worker(front_cell);
+        return add_successor(in_node, 1*forward_cost, false);
+    } else if (front_type == box and box_free(in_node, front_cell + step)) {
         // PUSH MOVE
-        move_box(tmp_node_child,tmp_node_child->worker_pos.x + move_x,tmp_node_child->worker_pos.y + move_y,move_x,move_y);
-        tmp_node_child->worker_pos.x = tmp_node_child->worker_pos.x + move_x;
-        tmp_node_child->worker_pos.y = tmp_node_child->worker_pos.y + move_y;
-
-        feature_node* tmp_node_child_for_check = tmp_node_child;
-        if (hash_table_insert(tmp_node_child_for_check, hash_table_ptr)) {
-            point2D tmp_point;
-            tmp_point.x = tmp_node_child->worker_pos.x + move_x;
-            tmp_point.y = tmp_node_child->worker_pos.y + move_y;
-            open_list.push_back(tmp_node_child);
-            return true;
-        } else {
-            if (tmp_node_child->cost_to_node < tmp_node_child_for_check->cost_to_node) {
-                tmp_node_child_for_check->cost_to_node = tmp_node_child->cost_to_node;
-                remove_node_from_parent(tmp_node_child_for_check);
-                tmp_node_child_for_check->parent = tmp_node_child->parent;
-                //add_node_to_parent(tmp_node_child_for_check,0);
-                update_node_to_parent(tmp_node_child_for_check, tmp_node_child);
-                remove_only_node(tmp_node_child);
-                return true;
-            } else {
-                remove_node(tmp_node_child);
+        begin_successor(in_node);
+        move_box(&successor_node, front_cell, front_cell + step);
+        if (freeze_deadlock(&successor_node, front_cell + step) or pattern_deadlock(&successor_node, front_cell + step, front_cell))
+            return false;
+        if (push_splits_area(&successor_node, front_cell + step, front_cell)) {
+            reachable_region(&successor_node, front_cell);
+            if (corral_deadlock(&successor_node, front_cell + step, front_cell))
                 return false;
-            }
         }
-    } else {
-        remove_node(tmp_node_child);
-        return false;
+        successor_move_worker(front_cell);
+        return add_successor(in_node, 1*approach_cost, true);
     }
     return false;
 }
@@ -535,53 +971,15 @@ bool Sokoban_features::move_backward(feature_node* in_node)
 // Adds the backwards move node to the open list if it does NOT exist.
 // If the node already exists the tree is manipulated if the new node has a smaller cost to node
 {
-    feature_node* tmp_node_child = insert_child(in_node);
-    int move_x = 0;
-    int move_y = 0;
-    if (tmp_node_child->worker_dir == NORTH) {
-        move_y = 1;
-    } else if (tmp_node_child->worker_dir == EAST) {
-        move_x = -1;
-    } else if (tmp_node_child->worker_dir == SOUTH) {
-        move_y = -1;
-    } else if (tmp_node_child->worker_dir == WEST) {
-        move_x = 1;
-    }
-
-    // First test if there is free space to move forward
-    // second test if there is a box in front and if there is test for freespace or goal in front of box
-    if (point_type(tmp_node_child, tmp_node_child->worker_pos.x + move_x, tmp_node_child->worker_pos.y + move_y, worker) == freespace
-	or point_type(tmp_node_child, tmp_node_child->worker_pos.x + move_x, tmp_node_child->worker_pos.y + move_y, worker) == goal) {
-        // MOVE FORWARD TO FREESPACE
-        //tmp_node_child->cost_to_node = tmp_node_child->cost_to_node + 1*backward_cost;
-        update_node_cost(tmp_node_child, 1*backward_cost);
-        tmp_node_child->worker_pos.x = tmp_node_child->worker_pos.x + move_x;
-        tmp_node_child->worker_pos.y = tmp_node_child->worker_pos.y + move_y;
-        //print_node(tmp_node_child);
-
-        feature_node* tmp_node_child_for_check = tmp_node_child;
-        if (hash_table_insert(tmp_node_child_for_check, hash_table_ptr)) {
-            open_list.push_back(tmp_node_child);
-            return true;
-        } else {
-            // Check if the returned
-            if (tmp_node_child->cost_to_node < tmp_node_child_for_check->cost_to_node) {
-                tmp_node_child_for_check->cost_to_node = tmp_node_child->cost_to_node;
-                remove_node_from_parent(tmp_node_child_for_check);
-                tmp_node_child_for_check->parent = tmp_node_child->parent;
-                //add_node_to_parent(tmp_node_child_for_check,0);
-                update_node_to_parent(tmp_node_child_for_check, tmp_node_child);
-                remove_only_node(tmp_node_child);
-                return true;
-            } else {
-                remove_node(tmp_node_child);
-                return false;
-            }
-        }
-        return false;
-    } else {
-        remove_node(tmp_node_child);
-        return false;
+    METRIC_TIME(phase_moves);
+    int back_cell = in_node->worker_cell() - direction_step(in_node->worker_dir());
+
+    // Test if there is free space to move backward
+    int back_type = point_type(in_node, back_cell, worker);
+    if (back_type == freespace or back_type == goal) {
+        begin_successor(in_node);
+        successor_move_worker(back_cell);
+        return add_successor(in_node, 1*backward_cost, false);
     }
     return false;
 }
@@ -589,67 +987,279 @@ bool Sokoban_features::turn_right(feature_node* in_node)
 // Adds the right turn node to the open list if it does NOT exist.
 // If the node already exists the tree is manipulated if the new node has a smaller cost to node
 {
+    METRIC_TIME(phase_moves);
 	// Right CW
-	feature_node* tmp_node_child_cw = insert_child(in_node);
-	// Test for deploy NOTE
-	//tmp_node_child_cw->cost_to_node = tmp_node_child_cw->cost_to_node + 1*left_cost;
-    update_node_cost(tmp_node_child_cw, 1*left_cost);
-	if (tmp_node_child_cw->worker_dir >= WEST) {
-		tmp_node_child_cw->worker_dir = NORTH;
+    int new_dir = in_node->worker_dir();
+	if (new_dir >= WEST) {
+		new_dir = NORTH;
 	} else {
-		tmp_node_child_cw->worker_dir += 1;
-	}
-	feature_node* tmp_node_child_for_check_cw = tmp_node_child_cw;
-	if (hash_table_insert(tmp_node_child_for_check_cw, hash_table_ptr)) {
-		open_list.push_back(tmp_node_child_cw);
-		return true;
-	} else {
-		if (tmp_node_child_cw->cost_to_node < tmp_node_child_for_check_cw->cost_to_node) {
-			tmp_node_child_for_check_cw->cost_to_node = tmp_node_child_cw->cost_to_node;
-			remove_node_from_parent(tmp_node_child_for_check_cw);
-			tmp_node_child_for_check_cw->parent = tmp_node_child_cw->parent;
-			//add_node_to_parent(tmp_node_child_for_check_cw,0);
-            update_node_to_parent(tmp_node_child_for_check_cw, tmp_node_child_cw);
-			remove_only_node(tmp_node_child_cw);
-			return true;
-		} else {
-			remove_node(tmp_node_child_cw);
-			return false;
-		}
+		new_dir += 1;
 	}
+    begin_successor(in_node);
+    successor_turn(new_dir);
+    return add_successor(in_node, 1*right_cost, false);
 }
 bool Sokoban_features::turn_left(feature_node* in_node)
 // Adds the left turn node to the open list if it does NOT exist.
 // If the node already exists the tree is manipulated if the new node has a smaller cost to node
 {
+    METRIC_TIME(phase_moves);
 	// Left CCW
-	feature_node* tmp_node_child_ccw = insert_child(in_node);
-	// test for deploy NOTE
-	//tmp_node_child_ccw->cost_to_node = tmp_node_child_ccw->cost_to_node + 1*left_cost;
-    update_node_cost(tmp_node_child_ccw, 1*left_cost);
-	if (tmp_node_child_ccw->worker_dir <= NORTH) {
-		tmp_node_child_ccw->worker_dir = WEST;
+    int new_dir = in_node->worker_dir();
+	if (new_dir <= NORTH) {
+		new_dir = WEST;
 	} else {
-		tmp_node_child_ccw->worker_dir -= 1;
-	}
-	feature_node* tmp_node_child_for_check_ccw = tmp_node_child_ccw;
-	if (hash_table_insert(tmp_node_child_for_check_ccw, hash_table_ptr)) {
-		open_list.push_back(tmp_node_child_ccw);
-		return true;
-	} else {
-		if (tmp_node_child_ccw->cost_to_node < tmp_node_child_for_check_ccw->cost_to_node) {
-			tmp_node_child_for_check_ccw->cost_to_node = tmp_node_child_ccw->cost_to_node;
-			remove_node_from_parent(tmp_node_child_for_check_ccw);
-			tmp_node_child_for_check_ccw->parent = tmp_node_child_ccw->parent;
-			//add_node_to_parent(tmp_node_child_for_check_ccw,0);
-            update_node_to_parent(tmp_node_child_for_check_ccw, tmp_node_child_ccw);
-			remove_only_node(tmp_node_child_ccw);
-			return true;
-		} else {
-			remove_node(tmp_node_child_ccw);
-			return false;
-		}
+		new_dir -= 1;
 	}
+    begin_successor(in_node);
+    successor_turn(new_dir);
+    return add_successor(in_node, 1*left_cost, false);
+}
+
+void Sokoban_features::begin_successor(feature_node* in_node)
+// Starts a new successor of the node in successor_node; the move methods then apply the move delta to it
+// Nothing is allocated until add_successor knows that the state is new
+{
+	peeked_notes++;
+    copy(in_node->boxes, in_node->boxes + box_count, successor_boxes.begin());
+    successor_node.boxes = successor_boxes.data();
+    successor_node.worker_word = in_node->worker_word;
+    successor_node.zobrist_key = in_node->zobrist_key;
+}
+
+void Sokoban_features::successor_move_worker(int in_cell)
+// Moves the worker of the successor to the cell and updates its key
+{
+    successor_node.zobrist_key ^= zobrist_worker[successor_node.worker_cell()] ^ zobrist_worker[in_cell];
+    successor_node.set_worker(in_cell, successor_node.worker_dir());
+}
+
+void Sokoban_features::successor_turn(int in_dir)
+// Turns the worker of the successor to the direction and updates its key
+{
+    successor_node.zobrist_key ^= zobrist_dir[successor_node.worker_dir()] ^ zobrist_dir[in_dir];
+    successor_node.set_worker(successor_node.worker_cell(), in_dir);
+}
+
+bool Sokoban_features::add_successor(feature_node* in_node, double edge_cost, bool boxes_moved)
+// Looks the successor up by its key before anything is allocated
+// A new state is materialised as a child and added to the open list; a known state reached with a smaller cost is moved to the new parent
+// Returns true if the tree was changed
+{
+    if (chosen_graph_search == HDA)
+        return hda_send(in_node, edge_cost, boxes_moved);
+    if (chosen_graph_search == IDAstar)
+        return ida_add_child(in_node, edge_cost, boxes_moved);
+    double new_cost = in_node->cost_to_node + edge_cost;
+    feature_node* tmp_node_for_check = &successor_node;
+    if (hash_table_exist(successor_node.zobrist_key, tmp_node_for_check, hash_table_ptr)) {
+        METRIC_COUNT(duplicates);
+        if (new_cost < tmp_node_for_check->cost_to_node) {
+            reparent_node(tmp_node_for_check, in_node, new_cost);
+            return true;
+        }
+        return false;
+    }
+    double tmp_heuristic = 0; // No heuristic for BF
+    if (chosen_graph_search != BF) {
+        tmp_heuristic = successor_heuristic(in_node, boxes_moved);
+        if (tmp_heuristic >= MATCHING_UNREACHABLE) {
+            METRIC_COUNT(prunes_unreachable);
+            return false; // a box cannot be pushed to any free goal; the state is dead
+        }
+    }
+    feature_node* tmp_node_child = insert_child(in_node);
+    tmp_node_child->cost_to_node = new_cost;
+    in_node->children_edge_cost.back() = edge_cost;
+    tmp_node_child->heuristic = tmp_heuristic;
+    hash_table_insert(tmp_node_child->zobrist_key, tmp_node_child, hash_table_ptr);
+    open_list_push(tmp_node_child);
+    METRIC_COUNT(generations);
+    return true;
+}
+
+void Sokoban_features::reparent_node(feature_node* in_node, feature_node* new_parent, double new_cost)
+// Moves an existing node below a new parent which reaches it with the smaller new_cost
+// The descendants of the node are reached cheaper by the same amount, so their cost_to_node is lowered as well; otherwise
+// a goal below the node would report the cost of the old path
+{
+    METRIC_COUNT(reparentings);
+    double saving = in_node->cost_to_node - new_cost;
+    remove_node_from_parent(in_node);
+    in_node->parent = new_parent;
+    in_node->depth = new_parent->depth+1;
+    add_child_link(new_parent, in_node, new_cost - new_parent->cost_to_node);
+    vector< feature_node* > tree_stack(1, in_node);
+    while (tree_stack.size()) {
+        feature_node* tmp_node = tree_stack.back();
+        tree_stack.pop_back();
+        tree_stack.insert(tree_stack.end(), tmp_node->children.begin(), tmp_node->children.end());
+        if (tmp_node != in_node)
+            tmp_node->depth = tmp_node->parent->depth+1;
+        if (tmp_node->backed_f >= 0)
+            tmp_node->backed_f -= saving; // the forgotten children are reached cheaper as well
+        tmp_node->cost_to_node -= saving;
+        if (tmp_node != goal_ptr)
+            reopen_node(tmp_node);
+    }
+}
+
+void Sokoban_features::reopen_node(feature_node* in_node)
+// Restores the open list after the cost_to_node of the node has been lowered; an expanded node is searched again where the
+// solver expands nodes more than once so the smaller cost reaches the successors that are not its children
+{
+    if (chosen_graph_search == SMAstar and in_node->heap_index < 0)
+        open_list_push(in_node); // SMAstar keeps no closed list, a cheaper expanded node is expanded again to pass the cost on
+    else if ((chosen_graph_search == WAstar or chosen_graph_search == ARAstar) and in_node->heap_index < 0) {
+        if (in_node->expanded_in == ara_search)
+            ara_inconsistent.push_back(in_node); // expanded again by the next search (see solve_ara)
+        else
+            open_list_push(in_node);
+    } else
+        open_list_decrease_key(in_node);
+}
+
+// Memory accounting methods ***************************************************
+void Sokoban_features::add_child_link(feature_node* parent_node, feature_node* child_node, double edge_cost)
+// Appends a child and its edge cost to the parent and accounts for the growth of the child vectors
+{
+    children_bytes -= child_vector_bytes(parent_node);
+    parent_node->children.push_back(child_node);
+    parent_node->children_edge_cost.push_back(edge_cost);
+    children_bytes += child_vector_bytes(parent_node);
+}
+
+size_t Sokoban_features::child_vector_bytes(feature_node* in_node)
+// Returns the bytes allocated by the child vectors of a node
+{
+    return in_node->children.capacity() * sizeof(feature_node*) + in_node->children_edge_cost.capacity() * sizeof(double);
+}
+
+Sokoban_features::memory_usage Sokoban_features::get_memory_usage()
+// Returns the bytes the search structures hold now; O(1)
+{
+    memory_usage tmp_usage;
+    tmp_usage.nodes = node_arena.capacity() * sizeof(feature_node) + box_chunks.size() * BOX_CHUNK_SLOTS * box_count * sizeof(cell_t);
+    tmp_usage.children = children_bytes;
+    tmp_usage.open_list = (open_list.capacity() + other_open_list.capacity()) * sizeof(feature_node*);
+    tmp_usage.closed_list = closed_list.capacity() * sizeof(feature_node*);
+    tmp_usage.hash_table = (hash_table.capacity() + other_hash_table.capacity()) * sizeof(Hash_table< feature_node >::hash_node);
+    tmp_usage.hash_table += ida_table.capacity() * sizeof(ida_entry);
+#ifdef FULL_STATE_CHECK
+    tmp_usage.hash_table += ida_table_boxes.capacity() * sizeof(cell_t);
+#endif
+    return tmp_usage;
+}
+
+Sokoban_features::memory_usage Sokoban_features::get_memory_peak()
+// Returns the high-water mark of every structure; its total is the sum of the peaks, so at least the largest sampled total
+{
+    return memory_peak;
+}
+
+size_t Sokoban_features::get_peak_rss()
+// Returns the peak resident set size of the process in bytes
+{
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return usage.ru_maxrss * 1024UL; // kilobytes on Linux
+}
+
+void Sokoban_features::memory_tick()
+// Counts an expansion and samples the memory every MEMORY_SAMPLE_EXPANSIONS expansions
+{
+    if (++memory_ticks % MEMORY_SAMPLE_EXPANSIONS == 0)
+        memory_sample();
+}
+
+void Sokoban_features::memory_sample()
+// Raises the high-water mark of every structure to its current size
+{
+    memory_usage tmp_usage = get_memory_usage();
+    memory_peak.nodes = max(memory_peak.nodes, tmp_usage.nodes);
+    memory_peak.children = max(memory_peak.children, tmp_usage.children);
+    memory_peak.open_list = max(memory_peak.open_list, tmp_usage.open_list);
+    memory_peak.closed_list = max(memory_peak.closed_list, tmp_usage.closed_list);
+    memory_peak.hash_table = max(memory_peak.hash_table, tmp_usage.hash_table);
+}
+
+// Metrics methods *************************************************************
+Search_metrics& Sokoban_features::get_metrics()
+// Returns the metrics of the last search; all zero unless compiled with SEARCH_METRICS
+{
+    return metrics;
+}
+
+void Sokoban_features::set_metrics_file(const string& file_name)
+// Sets the file the metrics are written to
+{
+    metrics_file = file_name;
+}
+
+void Sokoban_features::set_metrics_interval(long long in_interval_us)
+// Sets the time between two metric dumps during the search; 0 (default) only dumps when the search is over
+{
+    metrics_interval = in_interval_us;
+}
+
+void Sokoban_features::metrics_expansion()
+// Counts an expansion and dumps the metrics when the interval has passed; the clock is only read every METRICS_CHECK_EXPANSIONS
+{
+    metrics.expansions++;
+    if (metrics_interval > 0 and metrics.expansions % METRICS_CHECK_EXPANSIONS == 0 and currentTimeUs() - metrics_last_dump >= metrics_interval)
+        metrics_dump(false);
+}
+
+void Sokoban_features::metrics_dump(bool final_dump)
+// Appends the metrics as one line of JSON to metrics_file together with the solver, the time since the start and the list sizes
+{
+    metrics_last_dump = currentTimeUs();
+    ofstream dump_file(metrics_file, ios::app);
+    dump_file << "{\"solver\":" << chosen_graph_search << ",\"final\":" << (final_dump ? "true" : "false")
+              << ",\"elapsed_us\":" << metrics_last_dump - metrics_start << ",\"open_list\":" << get_open_list_size()
+              << ",\"closed_list\":" << get_closed_list_size() << ",\"solved\":" << (goal_ptr != nullptr ? "true" : "false")
+              << ",\"memory_bytes\":" << get_memory_usage().total() << ",\"memory_peak_bytes\":" << get_memory_peak().total()
+              << ",\"metrics\":" << metrics.to_json() << "}" << endl;
+}
+
+// Push-level search methods ***************************************************
+int Sokoban_features::direction_step(int in_dir)
+// Returns the cell index offset of one step in the direction
+{
+    return map->cell_step(in_dir-1); // NORTH, EAST, SOUTH, WEST are the sides 0 to 3 of the map
+}
+
+bool Sokoban_features::worker_free(feature_node* in_node, int in_cell)
+// Tests if the worker can stand on the cell; no obstacle and no box
+{
+    return !(map->cell_flags(in_cell) & CELL_WALL) and !box_at(in_node, in_cell);
+}
+
+bool Sokoban_features::box_free(feature_node* in_node, int in_cell)
+// Tests if a box can be pushed onto the cell; a goal or a cell which is not dead for boxes, and no box
+{
+    return !(map->cell_flags(in_cell) & (CELL_WALL | CELL_BOX_DEAD)) and !box_at(in_node, in_cell);
+}
+
+int Sokoban_features::reachable_region(feature_node* in_node, int start_cell)
+// Marks every cell the worker can reach from start_cell without pushing (see cell_reachable)
+// Flood fill on bitboards so a whole word of cells is grown per operation instead of testing cell by cell
+// Returns the canonical worker cell of the region; the smallest reachable cell index which is the top-left cell
+{
+    free_bits.assign(floor_bits);
+    for (int i = 0; i < box_count; i++)
+        free_bits.reset(in_node->boxes[i]);
+    reach_bits.clear();
+    reach_bits.set(start_cell);
+    reach_bits.flood(free_bits, direction_step(SOUTH));
+    return reach_bits.lowest();
+}
+
+bool Sokoban_features::cell_reachable(int in_cell)
+// Tests if the cell was reached by the last call of reachable_region
+{
+    return reach_bits.test(in_cell);
 }
 
 int  Sokoban_features::point_type(feature_node* in_node, int in_x, int in_y, int map_type)
@@ -663,29 +1273,129 @@ int  Sokoban_features::point_type(feature_node* in_node, int in_x, int in_y, int
 int  Sokoban_features::point_type(feature_node* in_node, point2D &inPoint, int map_type)
 // Returns the type of the point; the actual return value is given by defines
 {
-	if ( (inPoint.x >= 0 and inPoint.x < map->get_width()) and (inPoint.y >= 0 and inPoint.y < map->get_height()) ) {
-		if (in_node->worker_pos.x == inPoint.x and in_node->worker_pos.y == inPoint.y)
-	        return worker;
-	    for (size_t i = 0; i < in_node->boxes.size(); i++)
-	        if (in_node->boxes.at(i).x == inPoint.x and in_node->boxes.at(i).y == inPoint.y)
-	            return box;
-	    return map->map_point_type(inPoint,map_type);
-	}
+	if ( (inPoint.x >= 0 and inPoint.x < map->get_width()) and (inPoint.y >= 0 and inPoint.y < map->get_height()) )
+        return point_type(in_node, map->cell_index(inPoint.x, inPoint.y), map_type);
     return undefined;
 }
+int  Sokoban_features::point_type(feature_node* in_node, int in_cell, int map_type)
+// Returns the type of a cell; the flat map of Map makes the static part a single load
+{
+    if (in_node->worker_cell() == in_cell)
+        return worker;
+    if (box_at(in_node, in_cell))
+        return box;
+    unsigned char tmp_flags = map->cell_flags(in_cell);
+    if (tmp_flags & CELL_GOAL)
+        return goal;
+    if ((tmp_flags & CELL_WALL) or (map_type == box and (tmp_flags & CELL_BOX_DEAD)))
+        return obstacle;
+    return freespace;
+}
 
 double Sokoban_features::calcualte_heuristic(feature_node* in_node)
-// Calculates and returns the heuristic for the input node.
+// Calculates and returns the heuristic for the input node; MATCHING_UNREACHABLE or more if a box cannot reach a free goal
+// Every push costs approach_cost, so the pushes of the box matching are a lower bound on the cost of the pushes. The step
+// solvers add the walk and turn bound of worker_heuristic; the three parts count different moves so their sum is admissible
 {
-    // Still no heuristic!!
-    int heuristic = 0; // integer due to the taxicap distance from the wavefront!
-    for (size_t i = 0; i < in_node->boxes.size(); i++) {
-        //cout << "Box " << i << " and goal " << in_node->box_goal_ref.at(i) << " has heuristic " << map->wavefront_distance(in_node->boxes.at(i), in_node->box_goal_ref.at(i)) << endl;
-        heuristic += map->wavefront_distance(in_node->boxes.at(i), in_node->box_goal_ref.at(i));
+    METRIC_TIME(phase_heuristic);
+    int pushes = box_heuristic(in_node);
+    if (pushes >= MATCHING_UNREACHABLE)
+        return pushes;
+    return pushes*approach_cost + worker_heuristic(in_node);
+}
+double Sokoban_features::successor_heuristic(feature_node* in_node, bool boxes_moved)
+// Returns the heuristic of successor_node, a successor of the input node
+// Without a box move only the worker part changes, so the box part of the parent (the expanded node) is kept
+{
+    if (boxes_moved) {
+        successor_node.parent = in_node;
+        return calcualte_heuristic(&successor_node);
     }
-    //cout << "Cost to node " << in_node->cost_to_node << endl;
-    //cout << "A* value " << in_node->cost_to_node+heuristic << endl;
-    return heuristic;
+    return in_node->heuristic - expanded_worker_heuristic + worker_heuristic(&successor_node);
+}
+double Sokoban_features::worker_heuristic(feature_node* in_node)
+// Lower bound on the cost of the walks and turns of the worker; 0 for the push level solvers whose edges are pushes only
+// Walk: before the first push the worker walks next to the box it pushes, at least the taxicab distance to the nearest box - 1
+// Turns: the worker faces the direction of every push, so the turns of any one box from the current direction of the
+// worker through its pushes to a goal are a lower bound. The boxes may share turns when their pushes interleave, so the
+// largest bound of a box is used and not the sum. Both parts change by at most one move per step, so the heuristic stays consistent
+{
+    if (chosen_graph_search == BF or chosen_graph_search == Push or chosen_graph_search == BiPush)
+        return 0;
+    int worker_cell = in_node->worker_cell();
+    int worker_side = in_node->worker_dir()-1;
+    int worker_x = map->cell_x(worker_cell);
+    int worker_y = map->cell_y(worker_cell);
+    int min_walk = MATCHING_UNREACHABLE;
+    int max_turns = 0;
+    bool solved = true;
+    for (int i = 0; i < box_count; i++) {
+        int box_cell = in_node->boxes[i];
+        min_walk = min(min_walk, abs(map->cell_x(box_cell) - worker_x) + abs(map->cell_y(box_cell) - worker_y) - 1);
+        if (map->cell_flags(box_cell) & CELL_GOAL)
+            continue; // may stay where it is
+        solved = false;
+        int box_turns = turn_distance[box_cell * 4 + worker_side];
+        if (box_turns < MATCHING_UNREACHABLE)
+            max_turns = max(max_turns, box_turns);
+    }
+    if (solved)
+        return 0;
+    return min_walk * min(forward_cost, backward_cost) + max_turns * min(left_cost, right_cost);
+}
+int Sokoban_features::turn_steps(int in_side1, int in_side2)
+// Returns the number of 90 degree turns between two sides (0 north, 1 east, 2 south, 3 west)
+{
+    int tmp_steps = abs(in_side1 - in_side2);
+    return tmp_steps == 3 ? 1 : tmp_steps;
+}
+int Sokoban_features::box_heuristic(feature_node* in_node)
+// Returns the number of pushes of the minimum cost perfect matching between the boxes and the goals (Hungarian algorithm)
+// A child where one box moved reuses the matching of its parent and only augments the row of the moved box, O(n^2) instead of O(n^3)
+{
+    if (in_node->parent != nullptr) {
+        feature_node* parent_node = in_node->parent;
+        if (!equal(parent_node->boxes, parent_node->boxes + box_count, matching_boxes.begin())) {
+            work_rows.assign(parent_node->boxes, parent_node->boxes + box_count);
+            matching_cost = matching_solve();
+            matching_boxes = work_rows;
+            matching_u = work_u;
+            matching_v = work_v;
+            matching_p = work_p;
+        }
+        int moved_row = -1;
+        int moved_cell = -1;
+        int moved_boxes = 0;
+        for (int i = 0; i < box_count; i++) {
+            if (!box_at(in_node, matching_boxes[i])) {
+                moved_row = i+1;
+                moved_boxes++;
+            }
+            if (!box_at(parent_node, in_node->boxes[i]))
+                moved_cell = in_node->boxes[i];
+        }
+        if (moved_boxes == 0)
+            return matching_cost;
+        if (moved_boxes == 1) {
+            work_rows = matching_boxes;
+            work_u = matching_u;
+            work_v = matching_v;
+            work_p = matching_p;
+            work_rows[moved_row-1] = moved_cell;
+            // Free the column of the moved box and lower its potential so all reduced costs of the row stay non-negative
+            int min_reduced = MATCHING_UNREACHABLE * box_count;
+            for (int j = 1; j <= box_count; j++) {
+                if (work_p[j] == moved_row)
+                    work_p[j] = 0;
+                min_reduced = min(min_reduced, goal_distance[(j-1) * map->get_cells() + moved_cell] - work_v[j]);
+            }
+            work_u[moved_row] = min_reduced;
+            matching_augment(moved_row);
+            return matching_sum();
+        }
+    }
+    work_rows.assign(in_node->boxes, in_node->boxes + box_count);
+    return matching_solve();
 }
 
 double Sokoban_features::calculate_euclidian_distance(point2D &inPoint1, point2D &inPoint2)
@@ -700,111 +1410,198 @@ int Sokoban_features::calculate_taxicab_distance(point2D &inPoint1, point2D &inP
     return abs(inPoint1.x-inPoint2.x)+abs(inPoint1.y-inPoint2.y);
 }
 
-void Sokoban_features::update_nearest_goals(feature_node* in_node)
-// Each node contains a box_goal_ref which is a vector where each of the boxes are associated with a goal
-// This method updates these associations which in term can be used for a heuristic
-// Currently it is just using the euclidian distance which is not a good distance, a better one would be a wavefront map for each of the goals
+void Sokoban_features::init_goal_distances()
+// Copies the push distance from every cell to every goal into the flat goal_distance table
 {
-    bool debug_update_nearest_goals = false;
-    //in_node->box_goal_ref.clear();
-    for (size_t i = 0; i < in_node->box_goal_ref.size(); i++) {
-        in_node->box_goal_ref.at(i) = -1;
+    int cells = map->get_cells();
+    goal_distance.assign(box_count * cells, MATCHING_UNREACHABLE);
+    for (int j = 0; j < box_count; j++) {
+        for (int i = 0; i < cells; i++) {
+            if (map->cell_flags(i) & CELL_WALL)
+                continue;
+            point2D tmp_point;
+            tmp_point.x = map->cell_x(i);
+            tmp_point.y = map->cell_y(i);
+            int tmp_distance = map->push_distance(tmp_point, j);
+            if (tmp_distance >= 0) // -1 is a cell a box cannot be pushed from to the goal
+                goal_distance[j * cells + i] = tmp_distance;
+        }
     }
-    bool missing_links = true;
-    while (missing_links) {
-        int tmp_id;
-        for (size_t i = 0; i < in_node->box_goal_ref.size(); i++) {
-            if (in_node->box_goal_ref.at(i) == -1) {
-                tmp_id = i;
-                break;
+    init_turn_distances();
+    matching_boxes.assign(box_count, -1);
+    work_u.resize(box_count+1);
+    work_v.resize(box_count+1);
+    work_p.resize(box_count+1);
+    work_way.resize(box_count+1);
+    work_minv.resize(box_count+1);
+    work_used.resize(box_count+1);
+}
+
+void Sokoban_features::init_turn_distances()
+// Fills turn_distance; a Dijkstra from the last push onto every goal back to the first push, one bucket per turn count, and
+// then the turns of the worker to the side of the first push. Only the walls limit the pushes (no worker reachability, boxes
+// or dead cells), so the turns are a lower bound of every push path
+{
+    int cells = map->get_cells();
+    turn_distance.assign(cells * 4, MATCHING_UNREACHABLE);
+    vector< vector< int > > buckets(1); // states cell * 4 + side
+    for (int i = 0; i < cells; i++) {
+        if (!(map->cell_flags(i) & CELL_GOAL))
+            continue;
+        for (int side = 0; side < 4; side++) {
+            int box_cell = i - map->cell_step(side);
+            if (!(map->cell_flags(box_cell) & CELL_WALL) and !(map->cell_flags(box_cell - map->cell_step(side)) & CELL_WALL)) {
+                turn_distance[box_cell * 4 + side] = 0; // the push onto the goal
+                buckets[0].push_back(box_cell * 4 + side);
             }
         }
-
-        double tmp_distance1 = 999999999;
-        double tmp_distance2 = 999999999;
-        int goal_id = -1;
-        bool tmp_goal_free;
-        int  goal_taken_by = -1;
-        if (debug_update_nearest_goals)
-            cout << "working on " << tmp_id << " pos " << in_node->boxes.at(tmp_id).x << ", " << in_node->boxes.at(tmp_id).y << endl;
-        for (size_t j = 0; j < in_node->boxes.size(); j++) {
-            tmp_distance2 = calculate_euclidian_distance(in_node->boxes.at(tmp_id),map->get_goals().at(j));
-            if (debug_update_nearest_goals)
-                cout << "calculated distance to goal " << j << ": " << tmp_distance2 << endl;
-            if (tmp_distance2 < tmp_distance1) {
-                tmp_goal_free = true;
-                for (size_t k = 0; k < in_node->box_goal_ref.size(); k++) {
-                    if (in_node->box_goal_ref.at(k) == j) {
-                        tmp_goal_free = false;
-                        goal_taken_by = k;
-                        if (debug_update_nearest_goals)
-                            cout << "goal " << j << " is taken by " << k << endl;
-                    }
-                }
-                if (tmp_goal_free) {
-                    goal_id = j;
-                    tmp_distance1 = tmp_distance2;
-                } else {
-                    if (calculate_euclidian_distance(in_node->boxes.at(tmp_id),map->get_goals().at(j)) < calculate_euclidian_distance(in_node->boxes.at(goal_taken_by), map->get_goals().at(in_node->box_goal_ref.at(goal_taken_by)))) {
-                        goal_id = j;
-                        tmp_distance1 = tmp_distance2;
-                    } else {
-                        if (debug_update_nearest_goals)
-                            cout << "cannot take goal " << j  << " with distance " << calculate_euclidian_distance(in_node->boxes.at(goal_taken_by), map->get_goals().at(in_node->box_goal_ref.at(goal_taken_by))) << endl;
-                        tmp_goal_free = true;
-                        goal_taken_by = -1;
-                    }
+    }
+    for (size_t turns = 0; turns < buckets.size(); turns++) {
+        for (size_t k = 0; k < buckets[turns].size(); k++) {
+            int state = buckets[turns][k];
+            if (turn_distance[state] != (int)turns)
+                continue; // reached with fewer turns since it was queued
+            int cell = state >> 2;
+            for (int side = 0; side < 4; side++) {
+                // The push to the side that brings the box to the cell; the worker stands behind the box
+                int box_cell = cell - map->cell_step(side);
+                if ((map->cell_flags(box_cell) & CELL_WALL) or (map->cell_flags(box_cell - map->cell_step(side)) & CELL_WALL))
+                    continue;
+                int tmp_turns = turns + turn_steps(side, state & 3);
+                if (tmp_turns < turn_distance[box_cell * 4 + side]) {
+                    turn_distance[box_cell * 4 + side] = tmp_turns;
+                    if ((int)buckets.size() <= tmp_turns)
+                        buckets.resize(tmp_turns+1);
+                    buckets[tmp_turns].push_back(box_cell * 4 + side);
                 }
             }
         }
-
-        in_node->box_goal_ref.at(tmp_id) = goal_id;
-        if (debug_update_nearest_goals)
-            cout << "goal pushed " << goal_id << " pos " << map->get_goals().at(goal_id).x << ", " << map->get_goals().at(goal_id).y << endl << endl;
-        for (size_t k = 0; k < in_node->box_goal_ref.size(); k++) {
-            if (in_node->box_goal_ref.at(k) == goal_id and k != tmp_id) {
-                if (debug_update_nearest_goals)
-                    cout << "Clearing " << k << endl << endl;
-                in_node->box_goal_ref.at(k) = -1;
-            }
+    }
+    vector< int > push_turns;
+    push_turns.swap(turn_distance);
+    turn_distance.assign(cells * 4, MATCHING_UNREACHABLE);
+    for (int i = 0; i < cells * 4; i++) {
+        for (int side = 0; side < 4; side++) {
+            if (push_turns[(i & ~3) + side] < MATCHING_UNREACHABLE)
+                turn_distance[i] = min(turn_distance[i], turn_steps(i & 3, side) + push_turns[(i & ~3) + side]);
         }
-
-        missing_links = false;
-        for (size_t i = 0; i < in_node->box_goal_ref.size(); i++) {
-            if (in_node->box_goal_ref.at(i) == -1) {
-                missing_links = true;
-                break;
+    }
+}
+void Sokoban_features::matching_augment(int in_row)
+// Assigns the unassigned row (box) to a goal along the shortest augmenting path and updates the potentials
+// Rows and columns are 1-based; work_p[j] is the row assigned to column j or 0
+{
+    int cells = map->get_cells();
+    int infinity = MATCHING_UNREACHABLE * (box_count+1);
+    work_p[0] = in_row;
+    int col0 = 0;
+    for (int j = 0; j <= box_count; j++) {
+        work_minv[j] = infinity;
+        work_used[j] = false;
+    }
+    do {
+        work_used[col0] = true;
+        int row0 = work_p[col0];
+        int delta = infinity;
+        int col1 = 0;
+        for (int j = 1; j <= box_count; j++) {
+            if (!work_used[j]) {
+                int reduced = goal_distance[(j-1) * cells + work_rows[row0-1]] - work_u[row0] - work_v[j];
+                if (reduced < work_minv[j]) {
+                    work_minv[j] = reduced;
+                    work_way[j] = col0;
+                }
+                if (work_minv[j] < delta) {
+                    delta = work_minv[j];
+                    col1 = j;
+                }
             }
         }
+        for (int j = 0; j <= box_count; j++) {
+            if (work_used[j]) {
+                work_u[work_p[j]] += delta;
+                work_v[j] -= delta;
+            } else
+                work_minv[j] -= delta;
+        }
+        col0 = col1;
+    } while (work_p[col0] != 0);
+    do {
+        int col1 = work_way[col0];
+        work_p[col0] = work_p[col1];
+        col0 = col1;
+    } while (col0);
+}
+
+int Sokoban_features::matching_solve()
+// Solves the matching of the work_rows boxes from scratch and returns its cost
+{
+    for (int j = 0; j <= box_count; j++) {
+        work_u[j] = 0;
+        work_v[j] = 0;
+        work_p[j] = 0;
     }
+    for (int i = 1; i <= box_count; i++)
+        matching_augment(i);
+    return matching_sum();
+}
+
+int Sokoban_features::matching_sum()
+// Returns the cost of the current work matching
+{
+    int cost = 0;
+    for (int j = 1; j <= box_count; j++)
+        cost += goal_distance[(j-1) * map->get_cells() + work_rows[work_p[j]-1]];
+    return cost;
 }
 
 unsigned long Sokoban_features::hash_node_to_key(feature_node* in_node)
-// Hashes a node
+// Hashes a node; the key is kept up to date by the move methods so this is just a lookup
 // the boxes are not treated as unique
 {
-    vector< int > tmp_vec;
-    for (size_t i = 0; i < in_node->boxes.size(); i++) {
-        tmp_vec.push_back((in_node->boxes.at(i).x * 10) + in_node->boxes.at(i).y);
-    }
-    sort(tmp_vec.begin(), tmp_vec.end());
-
-    string tmp_str = "";
-    tmp_str += to_string(in_node->worker_pos.x);
-    tmp_str += to_string(in_node->worker_pos.y);
-    tmp_str += to_string(in_node->worker_dir);
+    return in_node->zobrist_key;
+}
 
-    for (size_t i = 0; i < tmp_vec.size(); i++) {
-        tmp_str += to_string(tmp_vec.at(i));
+unsigned long Sokoban_features::zobrist_full_key(feature_node* in_node)
+// Computes the zobrist key of a node from scratch; only needed for the root
+{
+    unsigned long key = zobrist_dir[in_node->worker_dir()];
+    key ^= zobrist_worker[in_node->worker_cell()];
+    for (int i = 0; i < box_count; i++) {
+        key ^= zobrist_box[in_node->boxes[i]];
     }
+    return key;
+}
 
-    return str_hash(tmp_str);
+void Sokoban_features::init_zobrist_keys()
+// Draws the zobrist keys; a fixed seed keeps the search (and the hash table layout) reproducible
+{
+    mt19937_64 zobrist_rng(0x536f6b6f62616eUL);
+    int cells = map->get_cells();
+    zobrist_box.resize(cells);
+    zobrist_worker.resize(cells);
+    for (int i = 0; i < cells; i++) {
+        zobrist_box[i] = zobrist_rng();
+        zobrist_worker[i] = zobrist_rng();
+    }
+    zobrist_dir[0] = 0;
+    for (int dir = NORTH; dir <= WEST; dir++)
+        zobrist_dir[dir] = zobrist_rng();
 }
 
 bool Sokoban_features::nodes_match(feature_node* in_node1, feature_node* in_node2)
-// Hashes each node and compares the hashing value; note that the boxes are not treated as unique
+// Compares the full states of the nodes; note that the boxes are not treated as unique
 {
-    return hash_node_to_key(in_node1) == hash_node_to_key(in_node2);
+    return states_match(this, in_node1, in_node2);
+}
+
+bool Sokoban_features::states_match(void* in_features, feature_node* in_node1, feature_node* in_node2)
+// Full-state equality used by the hash table to tell 64-bit key collisions apart (when compiled with FULL_STATE_CHECK)
+// The boxes are kept sorted so the compact states can be compared directly
+{
+    int tmp_box_count = ((Sokoban_features*)in_features)->box_count;
+    return in_node1->worker_word == in_node2->worker_word
+        and equal(in_node1->boxes, in_node1->boxes + tmp_box_count, in_node2->boxes);
 }
 
 bool Sokoban_features::update_parent_node(feature_node* &in_node_child, feature_node* in_node_new_parent)
@@ -819,12 +1616,20 @@ bool Sokoban_features::update_parent_node(feature_node* &in_node_child, feature_
 void Sokoban_features::print_debug(const string& in_string)
 // A method for nicer debug messages
 {
-    cout << "[DEBUG] " << in_string << endl;
+    if (verbose)
+        cout << "[DEBUG] " << in_string << endl;
 }
 void Sokoban_features::print_info(const string& in_string)
 // A method for nicer info messages
 {
-    cout << "[INFO] " << in_string << endl;
+    if (verbose)
+        cout << "[INFO] " << in_string << endl;
+}
+
+void Sokoban_features::set_verbose(bool in_verbose)
+// Turns the info and debug messages on or off; the batch solver runs many solvers at once without them
+{
+    verbose = in_verbose;
 }
 
 void Sokoban_features::print_branch_up(feature_node* in_node)
@@ -844,38 +1649,17 @@ void Sokoban_features::print_branch_up(feature_node* in_node)
         branch.pop_back();
 		print_info("Depth is " + to_string(tmp_node->depth));
         print_info("Cost to node is " + to_string(tmp_node->cost_to_node));
-        print_info("Worker has direction: "+to_string(tmp_node->worker_dir));
+        print_info("Worker has direction: "+to_string(tmp_node->worker_dir()));
 		print_node(tmp_node);
 	}
 }
 
 bool Sokoban_features::goal_node(feature_node* in_node)
 // Tests whether or not the input node is a goal node; a goal node is a node where all the boxes are at the goals (no specific order nessecary)
+// Both the boxes and goal_cells are sorted and there are as many boxes as goals so they just have to be equal
 {
-	vector< int > tmp_vec_box;
-    for (size_t i = 0; i < in_node->boxes.size(); i++) {
-        tmp_vec_box.push_back((in_node->boxes.at(i).x * 10) + in_node->boxes.at(i).y);
-    }
-
-	vector< point2D > goals = map->get_goals();
-	vector< int > tmp_vec_goal;
-    for (size_t i = 0; i < goals.size(); i++) {
-        tmp_vec_goal.push_back((goals.at(i).x * 10) + goals.at(i).y);
-    }
-
-	bool equal = true;
-    int counter = 0;
-	for (size_t i = 0; i < tmp_vec_box.size(); i++) {
-        for (size_t j = 0; j < tmp_vec_goal.size(); j++) {
-            if (tmp_vec_box.at(i) == tmp_vec_goal.at(j)) {
-                counter++;
-            }
-        }
-	}
-    if (counter == tmp_vec_box.size()) {
-        return true;
-    }
-    return false;
+    METRIC_TIME(phase_goal_test);
+    return equal(in_node->boxes, in_node->boxes + box_count, goal_cells.begin());
 }
 bool Sokoban_features::goal_box(point2D in_box)
 // Tests if the input box is at a goal
@@ -893,200 +1677,213 @@ bool Sokoban_features::goal_box(point2D in_box)
 bool Sokoban_features::move_box(feature_node* in_node, int in_x, int in_y, int offset_x, int offset_y)
 // Moves a box given from the position of the box and moves it the given amount by the offset inputs.
 {
-	for (size_t i = 0; i < in_node->boxes.size(); i++) {
-		if (in_node->boxes.at(i).x == in_x and in_node->boxes.at(i).y == in_y) {
-			in_node->boxes.at(i).x = in_node->boxes.at(i).x + offset_x;
-			in_node->boxes.at(i).y = in_node->boxes.at(i).y + offset_y;
+    return move_box(in_node, map->cell_index(in_x, in_y), map->cell_index(in_x + offset_x, in_y + offset_y));
+}
+bool Sokoban_features::move_box(feature_node* in_node, int old_cell, int new_cell)
+// Moves the box on old_cell to new_cell
+// The boxes are kept sorted by shifting the moved box to its new place
+{
+    cell_t* boxes = in_node->boxes;
+	for (int i = 0; i < box_count; i++) {
+		if (boxes[i] == old_cell) {
+            while (i > 0 and boxes[i-1] > new_cell) {
+                boxes[i] = boxes[i-1];
+                i--;
+            }
+            while (i < box_count-1 and boxes[i+1] < new_cell) {
+                boxes[i] = boxes[i+1];
+                i++;
+            }
+            boxes[i] = new_cell;
+            in_node->zobrist_key ^= zobrist_box[old_cell] ^ zobrist_box[new_cell];
 			return true;
 		}
 	}
 	return false;
 }
 
+bool Sokoban_features::box_at(feature_node* in_node, int in_cell)
+// Tests if there is a box at the cell; the boxes are sorted so the scan stops early
+{
+    for (int i = 0; i < box_count and in_node->boxes[i] <= in_cell; i++)
+        if (in_node->boxes[i] == in_cell)
+            return true;
+    return false;
+}
+
 int  Sokoban_features::get_open_list_size()
-// Returns the open list
+// Returns the open list; with the open list of the backward search and the open lists of all HDA workers
 {
-    return open_list.size();
+    size_t tmp_size = open_list.size() + other_open_list.size();
+    for (size_t i = 0; i < hda_workers.size(); i++)
+        tmp_size += hda_workers[i]->open_list.size();
+    return tmp_size;
 }
 int  Sokoban_features::get_closed_list_size()
-// Returns the closed list
+// Returns the closed list; the expansions of the solvers without a closed list and the closed lists of all HDA workers
 {
-    return closed_list.size();
+    size_t tmp_size = closed_list.size() + expanded_nodes;
+    for (size_t i = 0; i < hda_workers.size(); i++)
+        tmp_size += hda_workers[i]->closed_list.size();
+    return tmp_size;
 }
 
-// Hash table methods **********************************************************
-bool Sokoban_features::hash_table_insert(feature_node* &in_node, vector< hash_node >* hash_ptr)
-// An overload function for the hash_table_insert; hashes the input node
+// Open list methods ***********************************************************
+void Sokoban_features::open_list_push(feature_node* in_node)
+// Adds a node to the open list; a FIFO queue for BF and an indexed binary min-heap on f for Astar and Push
 {
-    return hash_table_insert(hash_node_to_key(in_node), in_node, hash_ptr);
+    METRIC_COUNT(heap_pushes);
+    if (chosen_graph_search != BF) {
+        in_node->heap_index = open_list.size();
+        open_list.push_back(in_node);
+        heap_sift_up(in_node->heap_index);
+    } else {
+        open_list.push_back(in_node);
+    }
 }
-bool Sokoban_features::hash_table_insert(unsigned long in_hash_value, feature_node* &in_node, vector< hash_node >* hash_ptr)
-// inserts with a time constant of log(n) where n = hash_table_size
-// if the element exists the in_node is changed to the existing element so it can be used for futher processing
-// return true if element is inserted and false if it already exists
+
+Sokoban_features::feature_node* Sokoban_features::open_list_pop()
+// Removes and returns the node with the smallest f value from the heap in O(log n)
 {
-    hash_node tmp_hash_node;
-    tmp_hash_node.hash_value = in_hash_value;
-    tmp_hash_node.ref_node = in_node;
+    METRIC_COUNT(heap_pops);
+    feature_node* top_node = open_list.front();
+    heap_swap(0, open_list.size()-1);
+    open_list.pop_back();
+    top_node->heap_index = -1;
+    if (open_list.size())
+        heap_sift_down(0);
+    return top_node;
+}
 
-    if (hash_ptr->size() > 0) { // test if has_table is empty
-        int const start_hash_table = 0; // access this element as hash_ptr->begin()
-        int start_itr = start_hash_table;
-        int const end_hash_table = hash_ptr->size()-1; // access this element as hash_ptr->end()
-        int end_itr = end_hash_table;
+void Sokoban_features::open_list_decrease_key(feature_node* in_node)
+// Restores the heap order after the cost_to_node of a node in the open list has been lowered
+// Nodes which are not in the open list (already expanded) are left untouched
+{
+    if (chosen_graph_search != BF and in_node->heap_index >= 0) {
+        METRIC_COUNT(heap_decrease_keys);
+        heap_sift_up(in_node->heap_index);
+    }
+}
 
-        if (start_itr == end_itr) { // test if has_table only consists of 1 element
-            if (in_hash_value == hash_ptr->at(start_itr).hash_value) {
-                // element exists return ptr. NOTE
-                in_node = hash_ptr->at(start_itr).ref_node;
-                return false;
-            } else if (in_hash_value > hash_ptr->at(start_itr).hash_value) {
-                hash_ptr->push_back(tmp_hash_node);
-                return true; // node inserted after 1st element
-            } else {
-                hash_ptr->insert(hash_ptr->begin()+start_itr,tmp_hash_node);
-                return true; // node inserted before 1st element
-            }
-        }
+void Sokoban_features::open_list_remove(feature_node* in_node)
+// Removes a node from anywhere in the heap in O(log n)
+{
+    METRIC_COUNT(heap_removes);
+    size_t pos = in_node->heap_index;
+    heap_swap(pos, open_list.size()-1);
+    open_list.pop_back();
+    in_node->heap_index = -1;
+    if (pos < open_list.size()) {
+        feature_node* moved_node = open_list[pos];
+        heap_sift_up(pos);
+        heap_sift_down(moved_node->heap_index);
+    }
+}
 
-        //cout << "[DEBUG INFO: hash_table_insert] entering while loop for " << in_hash_value << endl;
-        int tmp_itr;
-        while (true) {
-            tmp_itr = (end_itr-start_itr)/2;
-            //cout << "[DEBUG INFO: hash_table_insert] tmp_itr has value " << tmp_itr << ", start " << start_itr << ", end " << end_itr << endl; // debug info
+double Sokoban_features::f_value(feature_node* in_node)
+// Returns the A* value of the node; the heuristic is weighted by WAstar and ARAstar and SMAstar orders a node with
+// forgotten children by their backed up f
+{
+    if (in_node->backed_f >= 0)
+        return in_node->backed_f;
+    return in_node->cost_to_node + search_weight * in_node->heuristic;
+}
 
-            if (tmp_itr == 0) {
-                if (in_hash_value == hash_ptr->at(start_itr).hash_value) {
-                    // element exists return ptr. NOTE
-                    in_node = hash_ptr->at(start_itr).ref_node;
-                    return false;
-                } else if (in_hash_value > hash_ptr->at(start_itr).hash_value) {
-                    if (in_hash_value == hash_ptr->at(end_itr).hash_value) {
-                        // element exists return ptr. NOTE
-                        in_node = hash_ptr->at(end_itr).ref_node;
-                        return false;
-                    } else if (in_hash_value > hash_ptr->at(end_itr).hash_value) {
-                        if (end_itr == end_hash_table) {
-                            hash_ptr->push_back(tmp_hash_node);
-                            return true; // node inserted at end of list
-                        } else {
-                            hash_ptr->insert(hash_ptr->begin() + end_itr + 1,tmp_hash_node);
-                            return true; // node inserted after end_ptr
-                        }
-                    } else {
-                        hash_ptr->insert(hash_ptr->begin() + end_itr,tmp_hash_node);
-                        return true; // node inserted between ptr's
-                    }
-                } else {
-                    hash_ptr->insert(hash_ptr->begin() + start_itr,tmp_hash_node); // insert at start itr space
-                    return true; // node inserted before 1st element
-                }
-            } else {
-                if (in_hash_value == hash_ptr->at(start_itr+tmp_itr).hash_value) {
-                    // element exists return ptr.
-                    in_node = hash_ptr->at(start_itr+tmp_itr).ref_node;
-                    return false;
-                } else if (in_hash_value > hash_ptr->at(start_itr+tmp_itr).hash_value) {
-                    start_itr += tmp_itr;
-                } else {
-                    end_itr -= tmp_itr;
-                }
-            }
-        }
-    } else {
-        hash_ptr->push_back(tmp_hash_node);
-        return true; // first element inserted
+bool Sokoban_features::heap_less(feature_node* in_node1, feature_node* in_node2)
+// Heap ordering; smallest f first and ties are broken towards the deepest node (largest cost_to_node)
+{
+    double f1 = f_value(in_node1);
+    double f2 = f_value(in_node2);
+    if (f1 != f2)
+        return f1 < f2;
+    return in_node1->cost_to_node > in_node2->cost_to_node;
+}
+
+void Sokoban_features::heap_swap(int pos1, int pos2)
+// Swaps two heap entries and keeps the heap_index of the nodes up to date
+{
+    feature_node* tmp_node = open_list[pos1];
+    open_list[pos1] = open_list[pos2];
+    open_list[pos2] = tmp_node;
+    open_list[pos1]->heap_index = pos1;
+    open_list[pos2]->heap_index = pos2;
+}
+
+void Sokoban_features::heap_sift_up(int pos)
+// Moves the entry at pos towards the top until its parent is smaller
+{
+    while (pos > 0) {
+        int parent_pos = (pos-1)/2;
+        if (!heap_less(open_list[pos], open_list[parent_pos]))
+            break;
+        heap_swap(pos, parent_pos);
+        pos = parent_pos;
     }
-    return true;
 }
 
-bool Sokoban_features::hash_table_exist(feature_node* &in_node, vector< hash_node >* hash_ptr)
+void Sokoban_features::heap_sift_down(int pos)
+// Moves the entry at pos towards the bottom until both children are larger
+{
+    int heap_size = open_list.size();
+    while (true) {
+        int smallest_pos = pos;
+        int left_pos = 2*pos+1;
+        int right_pos = 2*pos+2;
+        if (left_pos < heap_size and heap_less(open_list[left_pos], open_list[smallest_pos]))
+            smallest_pos = left_pos;
+        if (right_pos < heap_size and heap_less(open_list[right_pos], open_list[smallest_pos]))
+            smallest_pos = right_pos;
+        if (smallest_pos == pos)
+            break;
+        heap_swap(pos, smallest_pos);
+        pos = smallest_pos;
+    }
+}
+
+// Hash table methods **********************************************************
+bool Sokoban_features::hash_table_insert(feature_node* &in_node, Hash_table< feature_node >* hash_ptr)
+// An overload function for the hash_table_insert; hashes the input node
+{
+    return hash_table_insert(hash_node_to_key(in_node), in_node, hash_ptr);
+}
+bool Sokoban_features::hash_table_insert(unsigned long in_hash_value, feature_node* &in_node, Hash_table< feature_node >* hash_ptr)
+// inserts with amortised constant time (open addressing, see Hash_table.hpp)
+// if the element exists the in_node is changed to the existing element so it can be used for futher processing
+// return true if element is inserted and false if it already exists
+{
+    METRIC_TIME(phase_hashing);
+    return hash_ptr->insert(in_hash_value, in_node);
+}
+
+bool Sokoban_features::hash_table_exist(feature_node* &in_node, Hash_table< feature_node >* hash_ptr)
 // An overload function for the hash_table_exist; hashes the input node
 {
-    //cout << "[DEBUG: hashing] Hash key " << hash_node_to_key(in_node) << endl;
     return hash_table_exist(hash_node_to_key(in_node), in_node, hash_ptr);
 }
-bool Sokoban_features::hash_table_exist(unsigned long in_hash_value, feature_node* &in_node, vector< hash_node >* hash_ptr)
+bool Sokoban_features::hash_table_exist(unsigned long in_hash_value, feature_node* &in_node, Hash_table< feature_node >* hash_ptr)
 // Searches for a element in the the hash table and if it exists the pointer to the found object is passes back in in_node and it returns true; otherwise no pointer return and false return value
 {
-    if (hash_ptr->size() > 0) { // test if has_table is empty
-        int const start_hash_table = 0; // access this element as hash_ptr->begin()
-        int start_itr = start_hash_table;
-        int const end_hash_table = hash_ptr->size()-1; // access this element as hash_ptr->end()
-        int end_itr = end_hash_table;
-
-        int tmp_itr;
-        while (true) {
-            tmp_itr = (end_itr-start_itr)/2;
-            //cout << "[DEBUG INFO: hash_table_insert] tmp_itr has value " << tmp_itr << ", start " << start_itr << ", end " << end_itr << endl; // debug info
-
-            if (tmp_itr == 0) {
-                if (in_hash_value == hash_ptr->at(start_itr).hash_value) {
-                    in_node = hash_ptr->at(start_itr).ref_node;
-                    return true;
-                } else if (in_hash_value == hash_ptr->at(end_itr).hash_value) {
-                    in_node = hash_ptr->at(end_itr).ref_node;
-                    return true;
-                } else {
-                    return false;
-                }
-            } else {
-                if (in_hash_value == hash_ptr->at(start_itr+tmp_itr).hash_value) {
-                    in_node = hash_ptr->at(start_itr+tmp_itr).ref_node;
-                    return true;
-                } else if (in_hash_value > hash_ptr->at(start_itr+tmp_itr).hash_value) {
-                    start_itr += tmp_itr;
-                } else {
-                    end_itr -= tmp_itr;
-                }
-            }
-        }
-    } else {
-        return false;
-    }
+    METRIC_TIME(phase_hashing);
+    return hash_ptr->exist(in_hash_value, in_node);
 }
 
-bool Sokoban_features::hash_table_delete(feature_node* &in_node, vector< hash_node >* hash_ptr)
+bool Sokoban_features::hash_table_delete(feature_node* &in_node, Hash_table< feature_node >* hash_ptr)
 // An overload function for the hash_table_delete; hashes the input node
 {
     return hash_table_delete(hash_node_to_key(in_node), in_node, hash_ptr);
 }
-bool Sokoban_features::hash_table_delete(unsigned long in_hash_value, feature_node* &in_node, vector< hash_node >* hash_ptr)
+bool Sokoban_features::hash_table_delete(unsigned long in_hash_value, feature_node* &in_node, Hash_table< feature_node >* hash_ptr)
 // Deletes an element in the list if it exists (return value true)
 {
-    if (hash_ptr->size() > 0) { // test if has_table is empty
-        int const start_hash_table = 0; // access this element as hash_ptr->begin()
-        int start_itr = start_hash_table;
-        int const end_hash_table = hash_ptr->size()-1; // access this element as hash_ptr->end()
-        int end_itr = end_hash_table;
-
-        int tmp_itr;
-        while (true) {
-            tmp_itr = (end_itr-start_itr)/2;
-            //cout << "[DEBUG INFO: hash_table_insert] tmp_itr has value " << tmp_itr << ", start " << start_itr << ", end " << end_itr << endl; // debug info
-
-            if (tmp_itr == 0) {
-                if (in_hash_value == hash_ptr->at(start_itr).hash_value) {
-                    hash_ptr->erase(hash_ptr->begin() + start_itr);
-                    return true;
-                } else if (in_hash_value == hash_ptr->at(end_itr).hash_value) {
-                    hash_ptr->erase(hash_ptr->begin() + end_itr);
-                    return true;
-                } else {
-                    return false;
-                }
-            } else {
-                if (in_hash_value == hash_ptr->at(start_itr+tmp_itr).hash_value) {
-                    hash_ptr->erase(hash_ptr->begin() + start_itr+tmp_itr);
-                    return true;
-                } else if (in_hash_value > hash_ptr->at(start_itr+tmp_itr).hash_value) {
-                    start_itr += tmp_itr;
-                } else {
-                    end_itr -= tmp_itr;
-                }
-            }
-        }
-    } else {
-        return false;
-    }
+    METRIC_TIME(phase_hashing);
+    return hash_ptr->remove(in_hash_value, in_node);
 }
+
+// Methods of the solver variants and of the deadlock tests
+#include "Sokoban_push.hpp"
+#include "Sokoban_deadlocks.hpp"
+#include "Sokoban_bidirectional.hpp"
+#include "Sokoban_ida.hpp"
+#include "Sokoban_sma.hpp"
+#include "Sokoban_ara.hpp"
+#include "Sokoban_hda.hpp"
@@ -0,0 +1,298 @@
+//
+//  Sokoban_hda.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Hash-distributed A* (HDA) of Sokoban_features; the workers are Sokoban_features of their own, one per thread
+//  Included at the end of Sokoban_features.hpp, which declares the members
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Class include
+#include "Sokoban_features.hpp"
+
+// Parallel search methods *****************************************************
+bool Sokoban_features::solve_hda(int max_search)
+// Hash-distributed A* over the same moves as Astar on get_thread_count() workers, one per thread
+// A worker expands its cheapest open node as long as its f is below the cost of the cheapest goal found so far (incumbent)
+// and is idle otherwise; when every worker is idle and no message is left no open node anywhere can lead to a cheaper goal,
+// so the incumbent is optimal like the goal of the sequential A*
+// Returns false if max_search nodes were expanded before that
+{
+    int threads = get_thread_count();
+    hda_state.threads = threads;
+    hda_state.incumbent.store(numeric_limits< double >::infinity());
+    hda_state.goal_node_ptr = nullptr;
+    hda_state.pending.store(threads); // all workers start active
+    hda_state.expanded.store(0);
+    hda_state.max_search = max_search;
+    hda_state.done.store(false);
+    hda_state.exhausted.store(false);
+    for (int i = 0; i < threads; i++) {
+        hda_workers.push_back(new Sokoban_features());
+        hda_workers.back()->hda_init_worker(this, i);
+    }
+    hda_state.workers = hda_workers;
+
+    // The root is built here and its state is stored by the worker owning it
+    root = insert_child(nullptr);
+    Sokoban_features* root_worker = hda_workers[hda_owner(root)];
+    root_worker->begin_successor(root);
+    root_worker->hda_insert(nullptr, 0, 0, root->heuristic);
+
+    vector< thread > worker_threads;
+    for (int i = 1; i < threads; i++)
+        worker_threads.push_back(thread(&Sokoban_features::hda_run, hda_workers[i]));
+    hda_workers[0]->hda_run();
+    for (size_t i = 0; i < worker_threads.size(); i++)
+        worker_threads[i].join();
+
+    string expanded_per_worker;
+    for (int i = 0; i < threads; i++) {
+        deadlock_patterns.merge(hda_workers[i]->deadlock_patterns); // saved with the patterns of this solver
+#ifdef SEARCH_METRICS
+        metrics.add(hda_workers[i]->metrics);
+#endif
+        memory_usage worker_peak = hda_workers[i]->get_memory_peak(); // each worker is at its high-water mark at the end
+        memory_peak.nodes += worker_peak.nodes;
+        memory_peak.children += worker_peak.children;
+        memory_peak.open_list += worker_peak.open_list;
+        memory_peak.closed_list += worker_peak.closed_list;
+        memory_peak.hash_table += worker_peak.hash_table;
+        expanded_per_worker += (i ? " " : "") + to_string(hda_workers[i]->closed_list.size());
+    }
+    print_info("HDA expanded " + expanded_per_worker + " nodes on " + to_string(threads) + " workers");
+    goal_ptr = hda_state.goal_node_ptr;
+    return !hda_state.exhausted.load();
+}
+
+void Sokoban_features::hda_init_worker(Sokoban_features* in_owner, int in_id)
+// Prepares a default constructed solver as worker in_id of the HDA search started by in_owner
+// The map data is shared read only; the keys are drawn from the same seed so every worker agrees on the owner of a state
+{
+    map = in_owner->map;
+    init_compact_state();
+    init_zobrist_keys();
+    init_goal_distances();
+    deadlock_patterns = in_owner->deadlock_patterns;
+#ifdef FULL_STATE_CHECK
+    hash_table.set_match_function(&Sokoban_features::states_match, this);
+#endif
+    chosen_graph_search = HDA;
+    verbose = in_owner->verbose;
+    hda = &in_owner->hda_state;
+    hda_id = in_id;
+    hda_outbox.assign(hda->threads, nullptr);
+}
+
+void Sokoban_features::hda_run()
+// Search loop of one worker; stores the children sent to it and expands its own open nodes below the incumbent
+// Before a worker goes idle it sends all children it still holds, so hda->pending can only reach zero when the search is over
+{
+    int since_flush = 0;
+    while (!hda->done.load()) {
+        hda_receive();
+        if (open_list.size() and f_value(open_list.front()) < hda->incumbent.load()) {
+            feature_node* tmp_node = open_list_pop(); // node with the smallest f = cost_to_node + heuristic
+            closed_list.push_back(tmp_node);
+            METRIC_EXPANSION();
+            memory_tick();
+
+            move_forward(tmp_node);
+            move_backward(tmp_node);
+            turn_right(tmp_node);
+            turn_left(tmp_node);
+
+            if (++since_flush == HDA_FLUSH_EXPANSIONS) {
+                hda_flush_all();
+                since_flush = 0;
+            }
+            if (closed_list.size() % HDA_COUNT_EXPANSIONS == 0
+                and hda->expanded.fetch_add(HDA_COUNT_EXPANSIONS) + HDA_COUNT_EXPANSIONS >= hda->max_search) {
+                hda->exhausted.store(true);
+                hda->done.store(true);
+            }
+            continue;
+        }
+        hda_flush_all();
+        since_flush = 0;
+        if (!hda_idle) {
+            hda_idle = true;
+            hda->pending.fetch_sub(1);
+        }
+        if (hda->pending.load() == 0)
+            hda->done.store(true);
+        else
+            this_thread::yield();
+    }
+}
+
+int Sokoban_features::hda_owner(feature_node* in_node)
+// Returns the worker owning the state of the node; only the boxes count so all walking and turning between two pushes
+// stays on one worker and only the pushes are sent to other workers. On 2015competition with 4 workers this sends 12524
+// children for 360899 expansions; owning by the full key sends 959438 for 393481 (bench_solver --threads, SEARCH_METRICS)
+{
+    unsigned long box_key = in_node->zobrist_key ^ zobrist_worker[in_node->worker_cell()] ^ zobrist_dir[in_node->worker_dir()];
+    return (int)((((box_key * 0x9E3779B97F4A7C15UL) >> 32) * hda->threads) >> 32);
+}
+
+bool Sokoban_features::hda_send(feature_node* in_node, double edge_cost, bool boxes_moved)
+// HDA version of add_successor; the heuristic is computed by the worker that expands the parent (so the parent matching
+// cache is used) and the successor is stored here if this worker owns it and queued for its owner otherwise
+// Returns true if the successor was stored or sent
+{
+    double new_cost = in_node->cost_to_node + edge_cost;
+    int receiver = hda_owner(&successor_node);
+    feature_node* tmp_node_for_check = &successor_node;
+    if (receiver == hda_id and hash_table_exist(successor_node.zobrist_key, tmp_node_for_check, hash_table_ptr)
+        and new_cost >= tmp_node_for_check->cost_to_node)
+        return false;
+    double tmp_heuristic = successor_heuristic(in_node, boxes_moved);
+    if (tmp_heuristic >= MATCHING_UNREACHABLE)
+        return false; // a box cannot be pushed to any free goal; the state is dead
+    if (new_cost + tmp_heuristic >= hda->incumbent.load())
+        return false; // cannot lead to a cheaper goal than the one found
+    if (receiver == hda_id)
+        return hda_insert(in_node, in_node->depth+1, new_cost, tmp_heuristic);
+
+    METRIC_COUNT(hda_messages);
+    if (hda_outbox[receiver] == nullptr)
+        hda_outbox[receiver] = hda_new_batch();
+    hda_batch* tmp_batch = hda_outbox[receiver];
+    hda_message tmp_message;
+    tmp_message.zobrist_key = successor_node.zobrist_key;
+    tmp_message.parent = in_node;
+    tmp_message.cost_to_node = new_cost;
+    tmp_message.heuristic = tmp_heuristic;
+    tmp_message.worker_word = successor_node.worker_word;
+    tmp_message.depth = in_node->depth+1;
+    tmp_batch->messages.push_back(tmp_message);
+    tmp_batch->boxes.insert(tmp_batch->boxes.end(), successor_node.boxes, successor_node.boxes + box_count);
+    if (tmp_batch->messages.size() == HDA_BATCH_MESSAGES)
+        hda_flush(receiver);
+    return true;
+}
+
+bool Sokoban_features::hda_insert(feature_node* parent_node, int in_depth, double in_cost, double in_heuristic)
+// Stores the state in successor_node on this worker; a new state becomes an open node and a known state reached with a
+// smaller cost gets the new parent and is opened again, also when it has been expanded already, since the workers do not
+// expand in global f order and a state may be expanded before its cheapest path arrives from another worker
+// The parent may belong to another worker so the children lists are not kept; goal states are reported instead of expanded
+// Returns true if the state was stored or improved
+{
+    feature_node* tmp_node = &successor_node;
+    if (hash_table_exist(successor_node.zobrist_key, tmp_node, hash_table_ptr)) {
+        METRIC_COUNT(duplicates);
+        if (in_cost >= tmp_node->cost_to_node)
+            return false;
+        METRIC_COUNT(reparentings);
+        tmp_node->parent = parent_node;
+        tmp_node->depth = in_depth;
+        tmp_node->cost_to_node = in_cost;
+    } else {
+        tmp_node = node_arena.create(parent_node, in_depth);
+        tmp_node->boxes = box_slot_alloc();
+        copy(successor_node.boxes, successor_node.boxes + box_count, tmp_node->boxes);
+        tmp_node->worker_word = successor_node.worker_word;
+        tmp_node->zobrist_key = successor_node.zobrist_key;
+        tmp_node->cost_to_node = in_cost;
+        tmp_node->heuristic = in_heuristic;
+        hash_table_insert(tmp_node->zobrist_key, tmp_node, hash_table_ptr);
+        METRIC_COUNT(generations);
+    }
+    if (goal_node(tmp_node))
+        hda_report_goal(tmp_node);
+    else if (tmp_node->heap_index >= 0)
+        open_list_decrease_key(tmp_node);
+    else
+        open_list_push(tmp_node);
+    return true;
+}
+
+bool Sokoban_features::hda_receive()
+// Stores the children other workers sent to this worker and hands the empty batches back to their senders
+// An idle worker becomes active before the received messages stop counting in hda->pending
+// Returns true if anything was received
+{
+    bool received = false;
+    hda_batch* tmp_batch;
+    while ((tmp_batch = hda_inbox.pop()) != nullptr) {
+        if (hda_idle) {
+            hda->pending.fetch_add(1);
+            hda_idle = false;
+        }
+        double incumbent = hda->incumbent.load();
+        for (size_t i = 0; i < tmp_batch->messages.size(); i++) {
+            hda_message &tmp_message = tmp_batch->messages[i];
+            if (tmp_message.cost_to_node + tmp_message.heuristic >= incumbent)
+                continue;
+            copy(tmp_batch->boxes.begin() + i * box_count, tmp_batch->boxes.begin() + (i+1) * box_count, successor_boxes.begin());
+            successor_node.boxes = successor_boxes.data();
+            successor_node.worker_word = tmp_message.worker_word;
+            successor_node.zobrist_key = tmp_message.zobrist_key;
+            hda_insert(tmp_message.parent, tmp_message.depth, tmp_message.cost_to_node, tmp_message.heuristic);
+        }
+        hda->pending.fetch_sub(tmp_batch->messages.size());
+        hda->workers[tmp_batch->sender]->hda_pool.push(tmp_batch);
+        received = true;
+    }
+    return received;
+}
+
+Sokoban_features::hda_batch* Sokoban_features::hda_new_batch()
+// Returns an empty batch; batches handed back by the receivers are reused before a new one is allocated
+{
+    hda_batch* tmp_batch = hda_pool.pop();
+    if (tmp_batch == nullptr) {
+        tmp_batch = new hda_batch();
+        tmp_batch->sender = hda_id;
+        hda_batches.push_back(tmp_batch);
+    }
+    tmp_batch->messages.clear();
+    tmp_batch->boxes.clear();
+    return tmp_batch;
+}
+
+void Sokoban_features::hda_flush(int in_receiver)
+// Sends the batch being filled for the receiver; the messages count in hda->pending before they can be received
+{
+    hda_batch* tmp_batch = hda_outbox[in_receiver];
+    if (tmp_batch == nullptr)
+        return;
+    hda->pending.fetch_add(tmp_batch->messages.size());
+    hda->workers[in_receiver]->hda_inbox.push(tmp_batch);
+    hda_outbox[in_receiver] = nullptr;
+}
+
+void Sokoban_features::hda_flush_all()
+// Sends all batches being filled
+{
+    for (int i = 0; i < hda->threads; i++)
+        hda_flush(i);
+}
+
+void Sokoban_features::hda_report_goal(feature_node* in_node)
+// Makes the goal node the incumbent if it is cheaper than the goal found so far
+{
+    lock_guard< mutex > goal_lock(hda->goal_mutex);
+    if (in_node->cost_to_node < hda->incumbent.load()) {
+        hda->incumbent.store(in_node->cost_to_node);
+        hda->goal_node_ptr = in_node;
+    }
+}
+
+void Sokoban_features::set_thread_count(int in_threads)
+// Sets the number of workers of the HDA solver; 0 uses one worker per core
+{
+    hda_threads = max(in_threads, 0);
+}
+
+int  Sokoban_features::get_thread_count()
+// Returns the number of workers the HDA solver uses
+{
+    if (hda_threads > 0)
+        return hda_threads;
+    return max((int)thread::hardware_concurrency(), 1);
+}
@@ -0,0 +1,163 @@
+//
+//  Sokoban_ida.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Iterative deepening A* (IDAstar) of Sokoban_features
+//  Included at the end of Sokoban_features.hpp, which declares the members
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Class include
+#include "Sokoban_features.hpp"
+
+// Iterative deepening search methods ******************************************
+bool Sokoban_features::solve_ida(int max_search)
+// Iterative deepening A* over the same moves as Astar; a depth-first search that only follows nodes with f up to a threshold
+// which is raised to the smallest f that was cut off until a goal is found
+// Only the current path is kept (ida_path) and states seen in the current iteration are pruned through the fixed size
+// transposition table (see set_ida_table_entries), so the memory does not grow with the number of expanded nodes
+// The nodes of the solution path are created once it is found; returns false if max_search nodes were expanded first
+{
+    root = insert_child(nullptr); // Create tree root
+    ida_table.assign(ida_table_entries, ida_entry());
+#ifdef FULL_STATE_CHECK
+    ida_table_boxes.assign(ida_table_entries * box_count, 0);
+#endif
+    int iteration = 0;
+    double threshold = f_value(root);
+    while (threshold < numeric_limits< double >::infinity()) {
+        iteration++;
+        double next_threshold = numeric_limits< double >::infinity();
+        ida_path.assign(1, ida_frame{root->worker_word, root->zobrist_key, 0, root->heuristic, 0, -1});
+        ida_path_boxes.assign(root->boxes, root->boxes + box_count);
+        while (ida_path.size()) {
+            int depth = ida_path.size()-1;
+            if (ida_path[depth].next_child < 0) {
+                // First visit of the node on top of the path
+                ida_frame &tmp_frame = ida_path[depth];
+                double tmp_f = tmp_frame.cost_to_node + tmp_frame.heuristic;
+                if (tmp_f > threshold) {
+                    next_threshold = min(next_threshold, tmp_f);
+                    ida_path.pop_back();
+                    continue;
+                }
+                ida_node.boxes = &ida_path_boxes[depth * box_count];
+                ida_node.worker_word = tmp_frame.worker_word;
+                ida_node.zobrist_key = tmp_frame.zobrist_key;
+                ida_node.cost_to_node = tmp_frame.cost_to_node;
+                ida_node.heuristic = tmp_frame.heuristic;
+                if (goal_node(&ida_node)) {
+                    goal_ptr = ida_solution_path();
+                    return true;
+                }
+                size_t tmp_slot = tmp_frame.zobrist_key & (ida_table_entries-1);
+                ida_entry &tmp_entry = ida_table[tmp_slot];
+                bool tmp_seen = tmp_entry.iteration == iteration and tmp_entry.key == tmp_frame.zobrist_key;
+#ifdef FULL_STATE_CHECK
+                if (tmp_seen) {
+                    // A key collision must not prune a state that has not been searched
+                    ida_entry_node.worker_word = tmp_entry.worker_word;
+                    ida_entry_node.boxes = &ida_table_boxes[tmp_slot * box_count];
+                    tmp_seen = states_match(this, &ida_node, &ida_entry_node);
+                }
+#endif
+                if (tmp_seen and tmp_entry.cost_to_node <= tmp_frame.cost_to_node) {
+                    METRIC_COUNT(duplicates);
+                    ida_path.pop_back(); // seen in this iteration with a cost that is not larger; also catches cycles
+                    continue;
+                }
+                tmp_entry.key = tmp_frame.zobrist_key;
+                tmp_entry.cost_to_node = tmp_frame.cost_to_node;
+                tmp_entry.iteration = iteration;
+#ifdef FULL_STATE_CHECK
+                tmp_entry.worker_word = tmp_frame.worker_word;
+                copy(ida_node.boxes, ida_node.boxes + box_count, &ida_table_boxes[tmp_slot * box_count]);
+#endif
+
+                ida_children.resize((depth+1) * IDA_MAX_CHILDREN);
+                ida_children_boxes.resize((depth+1) * IDA_MAX_CHILDREN * box_count);
+                ida_path[depth].children = 0;
+                move_forward(&ida_node);
+                move_backward(&ida_node);
+                turn_right(&ida_node);
+                turn_left(&ida_node);
+                ida_path[depth].next_child = 0;
+                expanded_nodes++;
+                METRIC_EXPANSION();
+                memory_tick();
+                if (max_search <= expanded_nodes)
+                    return false;
+            }
+            ida_frame &tmp_frame = ida_path[depth];
+            if (tmp_frame.next_child == tmp_frame.children) {
+                ida_path.pop_back();
+                continue;
+            }
+            // Enter the next child; the children are sorted on f so the most promising one is followed first
+            int child = depth * IDA_MAX_CHILDREN + tmp_frame.next_child++;
+            ida_frame tmp_child = ida_children[child];
+            ida_path.push_back(tmp_child);
+            ida_path_boxes.resize((depth+1) * box_count); // drop the boxes of frames popped since
+            ida_path_boxes.insert(ida_path_boxes.end(), ida_children_boxes.begin() + child * box_count,
+                                  ida_children_boxes.begin() + (child+1) * box_count);
+        }
+        print_info("IDA iteration " + to_string(iteration) + " with threshold " + to_string(threshold) + " expanded " + to_string(expanded_nodes) + " nodes so far");
+        threshold = next_threshold;
+    }
+    return true; // the whole space has been searched without finding a goal; goal_ptr is still the nullptr
+}
+
+bool Sokoban_features::ida_add_child(feature_node* in_node, double edge_cost, bool boxes_moved)
+// IDA version of add_successor; stores successor_node as a child of the node on top of the path in f order
+// Returns true if the child was stored
+{
+    int depth = ida_path.size()-1;
+    double tmp_heuristic = successor_heuristic(in_node, boxes_moved);
+    if (tmp_heuristic >= MATCHING_UNREACHABLE) {
+        METRIC_COUNT(prunes_unreachable);
+        return false; // a box cannot be pushed to any free goal; the state is dead
+    }
+    METRIC_COUNT(generations);
+    ida_frame tmp_child{successor_node.worker_word, successor_node.zobrist_key, in_node->cost_to_node + edge_cost, tmp_heuristic, 0, -1};
+    double tmp_f = tmp_child.cost_to_node + tmp_child.heuristic;
+    int first = depth * IDA_MAX_CHILDREN;
+    int pos = first + ida_path[depth].children++;
+    while (pos > first and ida_children[pos-1].cost_to_node + ida_children[pos-1].heuristic > tmp_f) {
+        ida_children[pos] = ida_children[pos-1];
+        copy(ida_children_boxes.begin() + (pos-1) * box_count, ida_children_boxes.begin() + pos * box_count,
+             ida_children_boxes.begin() + pos * box_count);
+        pos--;
+    }
+    ida_children[pos] = tmp_child;
+    copy(successor_node.boxes, successor_node.boxes + box_count, ida_children_boxes.begin() + pos * box_count);
+    return true;
+}
+
+void Sokoban_features::set_ida_table_entries(size_t in_entries)
+// Sets the number of entries of the IDAstar transposition table; rounded down to a power of two
+{
+    ida_table_entries = 1;
+    while (ida_table_entries * 2 <= in_entries)
+        ida_table_entries *= 2;
+}
+
+Sokoban_features::feature_node* Sokoban_features::ida_solution_path()
+// Creates a node for every state on the path below the root and returns the last one (the goal)
+{
+    feature_node* tmp_node = root;
+    for (size_t i = 1; i < ida_path.size(); i++) {
+        begin_successor(tmp_node);
+        copy(ida_path_boxes.begin() + i * box_count, ida_path_boxes.begin() + (i+1) * box_count, successor_boxes.begin());
+        successor_node.worker_word = ida_path[i].worker_word;
+        successor_node.zobrist_key = ida_path[i].zobrist_key;
+        feature_node* tmp_node_child = insert_child(tmp_node);
+        tmp_node_child->cost_to_node = ida_path[i].cost_to_node;
+        tmp_node_child->heuristic = ida_path[i].heuristic;
+        tmp_node->children_edge_cost.back() = ida_path[i].cost_to_node - ida_path[i-1].cost_to_node;
+        tmp_node = tmp_node_child;
+    }
+    return tmp_node;
+}
@@ -0,0 +1,207 @@
+//
+//  Sokoban_push.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Push-level search methods of Sokoban_features; the successors of the Push and BiPush solvers are pushes (or pulls) of a box
+//  and the found chain of pushes is filled in with the single steps of the worker
+//  Included at the end of Sokoban_features.hpp, which declares the members
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Class include
+#include "Sokoban_features.hpp"
+
+// Push-level search methods ***************************************************
+int Sokoban_features::canonical_worker_cell(feature_node* in_node)
+// Returns the top-left cell the worker of the node can reach; nodes with the same boxes and canonical cell are the same push state
+{
+    return reachable_region(in_node, in_node->worker_cell());
+}
+
+bool Sokoban_features::generate_pushes(feature_node* in_node)
+// Adds a child for every legal push; the worker has to reach the cell behind the box and the cell in front of the box must be free
+// The child gets the canonical worker cell of the region the worker is in after the push
+// Returns true if the tree was changed
+{
+    METRIC_TIME(phase_moves);
+    canonical_worker_cell(in_node);
+    vector< int > push_moves; // box cell and step pairs
+    for (int i = 0; i < box_count; i++) {
+        for (int dir = NORTH; dir <= WEST; dir++) {
+            int step = direction_step(dir);
+            if (cell_reachable(in_node->boxes[i] - step) and box_free(in_node, in_node->boxes[i] + step)) {
+                push_moves.push_back(in_node->boxes[i]);
+                push_moves.push_back(step);
+            }
+        }
+    }
+    bool tree_changed = false;
+    for (size_t i = 0; i < push_moves.size(); i += 2) {
+        begin_successor(in_node);
+        move_box(&successor_node, push_moves[i], push_moves[i] + push_moves[i+1]);
+        if (freeze_deadlock(&successor_node, push_moves[i] + push_moves[i+1])
+            or pattern_deadlock(&successor_node, push_moves[i] + push_moves[i+1], push_moves[i]))
+            continue;
+        int canonical_cell = reachable_region(&successor_node, push_moves[i]);
+        if (push_splits_area(&successor_node, push_moves[i] + push_moves[i+1], push_moves[i])
+            and corral_deadlock(&successor_node, push_moves[i] + push_moves[i+1], push_moves[i]))
+            continue;
+        successor_move_worker(canonical_cell);
+        tree_changed |= add_successor(in_node, 1*approach_cost, true);
+    }
+    return tree_changed;
+}
+
+bool Sokoban_features::generate_pulls(feature_node* in_node)
+// Backward search version of generate_pushes; adds a child for every legal pull. The worker has to reach the cell next to
+// the box and the cell behind the worker must be free; the box follows the worker one step
+// The child gets the canonical worker cell of the region the worker is in after the pull
+// Returns true if the tree was changed
+{
+    METRIC_TIME(phase_moves);
+    canonical_worker_cell(in_node);
+    vector< int > pull_moves; // box cell and step pairs
+    for (int i = 0; i < box_count; i++) {
+        for (int dir = NORTH; dir <= WEST; dir++) {
+            int step = direction_step(dir);
+            if (cell_reachable(in_node->boxes[i] + step) and worker_free(in_node, in_node->boxes[i] + 2*step)) {
+                pull_moves.push_back(in_node->boxes[i]);
+                pull_moves.push_back(step);
+            }
+        }
+    }
+    bool tree_changed = false;
+    for (size_t i = 0; i < pull_moves.size(); i += 2) {
+        begin_successor(in_node);
+        move_box(&successor_node, pull_moves[i], pull_moves[i] + pull_moves[i+1]);
+        successor_move_worker(reachable_region(&successor_node, pull_moves[i] + 2*pull_moves[i+1]));
+        tree_changed |= add_successor(in_node, 1*approach_cost, true);
+    }
+    return tree_changed;
+}
+
+bool Sokoban_features::plan_walk(feature_node* in_node, int start_cell, int start_dir, int target_cell, int target_dir, vector< int > &walk_states)
+// Finds the cheapest sequence of forward, backward and turn moves that takes the worker from start to target without pushing
+// walk_states gets the visited (cell << 2 | dir-1) states after the start state; returns false if the target cannot be reached
+{
+    int states = map->get_cells() * 4;
+    vector< double > state_cost(states, -1);
+    vector< int > state_parent(states, -1);
+    priority_queue< pair< double, int >, vector< pair< double, int > >, greater< pair< double, int > > > walk_queue;
+    int start_state = (start_cell << 2) | (start_dir-1);
+    int target_state = (target_cell << 2) | (target_dir-1);
+    state_cost[start_state] = 0;
+    walk_queue.push(make_pair(0.0, start_state));
+    while (walk_queue.size()) {
+        double tmp_cost = walk_queue.top().first;
+        int tmp_state = walk_queue.top().second;
+        walk_queue.pop();
+        if (tmp_cost > state_cost[tmp_state])
+            continue;
+        if (tmp_state == target_state)
+            break;
+        int tmp_cell = tmp_state >> 2;
+        int tmp_dir = (tmp_state & 3) + 1;
+        int step = direction_step(tmp_dir);
+        int next_states[4];
+        double next_costs[4] = {forward_cost, backward_cost, left_cost, right_cost};
+        next_states[0] = next_states[1] = -1;
+        if (worker_free(in_node, tmp_cell + step))
+            next_states[0] = ((tmp_cell + step) << 2) | (tmp_dir-1);
+        if (worker_free(in_node, tmp_cell - step))
+            next_states[1] = ((tmp_cell - step) << 2) | (tmp_dir-1);
+        next_states[2] = (tmp_cell << 2) | ((tmp_dir+2) % 4); // CCW
+        next_states[3] = (tmp_cell << 2) | (tmp_dir % 4); // CW
+        for (int i = 0; i < 4; i++) {
+            if (next_states[i] < 0)
+                continue;
+            double next_cost = tmp_cost + next_costs[i];
+            if (state_cost[next_states[i]] < 0 or next_cost < state_cost[next_states[i]]) {
+                state_cost[next_states[i]] = next_cost;
+                state_parent[next_states[i]] = tmp_state;
+                walk_queue.push(make_pair(next_cost, next_states[i]));
+            }
+        }
+    }
+    if (state_cost[target_state] < 0)
+        return false;
+    walk_states.clear();
+    for (int tmp_state = target_state; tmp_state != start_state; tmp_state = state_parent[tmp_state])
+        walk_states.push_back(tmp_state);
+    reverse(walk_states.begin(), walk_states.end());
+    return true;
+}
+
+Sokoban_features::feature_node* Sokoban_features::expand_push_path(feature_node* push_goal)
+// Turns the chain of push nodes ending in push_goal into a chain of single step nodes (F/B/L/R moves)
+// so the solution can be converted to robot commands like the ones from the other solvers
+// Returns the last step node; its parent chain ends in a new step root with the initial worker position and direction
+{
+    vector< feature_node* > push_chain;
+    for (feature_node* tmp_node = push_goal; tmp_node != nullptr; tmp_node = tmp_node->parent)
+        push_chain.push_back(tmp_node);
+    reverse(push_chain.begin(), push_chain.end());
+
+    point2D tmp_worker = map->get_worker();
+    feature_node* step_node = node_arena.create(nullptr, 0);
+    step_node->boxes = box_slot_alloc();
+    copy(root->boxes, root->boxes + box_count, step_node->boxes);
+    step_node->set_worker(map->cell_index(tmp_worker.x, tmp_worker.y), NORTH);
+    step_node->zobrist_key = zobrist_full_key(step_node);
+    step_node->cost_to_node = 0;
+    step_node->heuristic = 0;
+
+    vector< int > walk_states;
+    for (size_t i = 1; i < push_chain.size(); i++) {
+        // Find the pushed box; the only box of the parent which is not in the child
+        int from_cell = -1;
+        int to_cell = -1;
+        for (int j = 0; j < box_count; j++) {
+            if (!box_at(push_chain[i], push_chain[i-1]->boxes[j]))
+                from_cell = push_chain[i-1]->boxes[j];
+            if (!box_at(push_chain[i-1], push_chain[i]->boxes[j]))
+                to_cell = push_chain[i]->boxes[j];
+        }
+        int push_dir = NORTH;
+        for (int dir = NORTH; dir <= WEST; dir++)
+            if (from_cell + direction_step(dir) == to_cell)
+                push_dir = dir;
+        int behind_cell = from_cell - direction_step(push_dir);
+        if (!plan_walk(step_node, step_node->worker_cell(), step_node->worker_dir(), behind_cell, push_dir, walk_states)) {
+            print_info("Could not fill in the steps of push " + to_string(i));
+            return nullptr;
+        }
+        for (size_t j = 0; j < walk_states.size(); j++) {
+            begin_successor(step_node);
+            double edge_cost;
+            if ((walk_states[j] >> 2) != step_node->worker_cell()) {
+                // A step is forward when it goes to the cell in front of the worker, otherwise it is backward
+                edge_cost = forward_cost;
+                if ((walk_states[j] >> 2) != step_node->worker_cell() + direction_step(step_node->worker_dir()))
+                    edge_cost = backward_cost;
+                successor_move_worker(walk_states[j] >> 2);
+            } else {
+                edge_cost = left_cost;
+                if ((walk_states[j] & 3) + 1 == (step_node->worker_dir() % 4) + 1)
+                    edge_cost = right_cost;
+                successor_turn((walk_states[j] & 3) + 1);
+            }
+            feature_node* tmp_node_child = insert_child(step_node);
+            tmp_node_child->cost_to_node = step_node->cost_to_node + edge_cost;
+            step_node->children_edge_cost.back() = edge_cost;
+            step_node = tmp_node_child;
+        }
+        // The push itself
+        begin_successor(step_node);
+        move_box(&successor_node, from_cell, to_cell);
+        successor_move_worker(from_cell);
+        feature_node* tmp_node_child = insert_child(step_node);
+        tmp_node_child->cost_to_node = step_node->cost_to_node + approach_cost;
+        step_node->children_edge_cost.back() = approach_cost;
+        step_node = tmp_node_child;
+    }
+    return step_node;
+}
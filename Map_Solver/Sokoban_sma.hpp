@@ -0,0 +1,116 @@
+//
+//  Sokoban_sma.hpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Memory bounded A* (SMAstar) of Sokoban_features
+//  Included at the end of Sokoban_features.hpp, which declares the members
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#pragma once
+
+// Class include
+#include "Sokoban_features.hpp"
+
+// Memory bounded search methods ***********************************************
+bool Sokoban_features::solve_sma(int max_search)
+// A* with a memory budget instead of a node limit (simplified SMA*); when the nodes no longer fit in the budget
+// the open leaves with the largest f are forgotten and their f is backed up into their parents (see sma_evict)
+// Nodes are goal tested when they are expanded so the goal is optimal like the one of IDAstar
+// No closed list is kept since forgotten nodes may be expanded again; returns false if max_search nodes were expanded first
+{
+    size_t node_bytes = sizeof(feature_node) + box_count * sizeof(cell_t)
+        + sizeof(Hash_table< feature_node >::hash_node) / HASH_TABLE_MAX_LOAD // hash table slots
+        + sizeof(feature_node*) // open list slot
+        + IDA_MAX_CHILDREN * (sizeof(feature_node*) + sizeof(double)); // children and children_edge_cost of the parent
+    size_t node_budget = max(sma_budget / node_bytes, (size_t)SMA_MIN_NODES);
+    print_info("Memory budget of " + to_string(sma_budget) + " bytes holds " + to_string(node_budget) + " nodes");
+
+    root = insert_child(nullptr); // Create tree root
+    hash_table_insert(root->zobrist_key, root, hash_table_ptr);
+    open_list_push(root);
+    size_t evicted = 0;
+    while (open_list.size()) {
+        feature_node* tmp_node = open_list_pop(); // node with the smallest f = cost_to_node + heuristic
+        if (goal_node(tmp_node)) {
+            goal_ptr = tmp_node;
+            break;
+        }
+        expanded_nodes++;
+        METRIC_EXPANSION();
+        memory_tick();
+        tmp_node->backed_f = -1; // the forgotten children are generated again
+
+        move_forward(tmp_node);
+        move_backward(tmp_node);
+        turn_right(tmp_node);
+        turn_left(tmp_node);
+
+        if (node_arena.size() > node_budget)
+            evicted += sma_evict(node_budget * SMA_EVICT_TARGET);
+        if (expanded_nodes%10000 == 0) {
+            print_info("Visited " + to_string(expanded_nodes) + " and " + to_string(open_list.size()) + " nodes waiting (forgot " + to_string(evicted) + " nodes)");
+        }
+        if (max_search <= expanded_nodes) {
+            return false;
+        }
+    }
+    print_info("Forgot " + to_string(evicted) + " nodes to stay within the memory budget");
+    return true;
+}
+
+size_t Sokoban_features::sma_evict(size_t target_nodes)
+// Forgets leaves of the tree until target_nodes nodes are left or no leaf is left; the root is always kept
+// Expanded leaves go first; all their successors were duplicates of nodes elsewhere in the tree (or deadlocks) so only
+// the duplicate detection for their own state is lost. Then the open leaves with the largest f are forgotten; the parent
+// of such a leaf is opened again with the smallest f of its forgotten children, so the search comes back to the
+// forgotten part once that f is the smallest and expanding the parent again regenerates the forgotten children
+// Returns the number of forgotten nodes
+{
+    vector< feature_node* > leaves;
+    vector< feature_node* > tree_stack(1, root);
+    while (tree_stack.size()) {
+        feature_node* tmp_node = tree_stack.back();
+        tree_stack.pop_back();
+        tree_stack.insert(tree_stack.end(), tmp_node->children.begin(), tmp_node->children.end());
+        if (tmp_node->children.empty() and tmp_node != root)
+            leaves.push_back(tmp_node);
+    }
+    size_t evict = min(leaves.size(), node_arena.size() - min(node_arena.size(), target_nodes));
+    nth_element(leaves.begin(), leaves.begin() + evict, leaves.end(),
+                [this](feature_node* in_node1, feature_node* in_node2) {
+                    if ((in_node1->heap_index < 0) != (in_node2->heap_index < 0))
+                        return in_node1->heap_index < 0; // expanded leaves first
+                    return heap_less(in_node2, in_node1); // then the largest f
+                });
+    for (size_t i = 0; i < evict; i++) {
+        feature_node* leaf = leaves[i];
+        feature_node* parent_node = leaf->parent;
+        double leaf_f = f_value(leaf);
+        bool leaf_open = leaf->heap_index >= 0;
+        if (leaf_open)
+            open_list_remove(leaf);
+        hash_table_delete(leaf->zobrist_key, leaf, hash_table_ptr);
+        remove_node(leaf);
+        if (!leaf_open)
+            continue;
+        // Back the f value up; the parent is ordered by the smallest f of its forgotten children. The heuristic of the
+        // parent is kept, its children derive their heuristic from it when they are generated again
+        // An expanded parent takes the f of the leaf even if an earlier backup made it larger, that backup has been expanded
+        if (parent_node->heap_index < 0) {
+            parent_node->backed_f = leaf_f;
+            open_list_push(parent_node);
+        } else if (leaf_f < f_value(parent_node)) {
+            parent_node->backed_f = leaf_f;
+            open_list_decrease_key(parent_node);
+        }
+    }
+    return evict;
+}
+
+void Sokoban_features::set_memory_budget(size_t in_bytes)
+// Sets the number of bytes the nodes of the SMAstar solver may use
+{
+    sma_budget = in_bytes;
+}
@@ -0,0 +1,81 @@
+//
+//  bench_hash_table.cpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Insert and lookup throughput of the duplicate detection hash table.
+//  Build and run with: make bench_hash_table && ./bench_hash_table
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <sys/time.h>
+
+#include "Hash_table.hpp"
+
+using namespace std;
+
+struct bench_node {
+    int id;
+};
+
+long long currentTimeUs()
+// Timer function
+{
+    timeval current;
+    gettimeofday(&current, 0);
+    return (long long)current.tv_sec * 1000000L + current.tv_usec;
+}
+
+void bench_states(size_t states)
+// Inserts the given number of random states, then looks all of them up and re-inserts them as duplicates
+{
+    mt19937_64 rng(states);
+    vector< unsigned long > keys(states);
+    for (size_t i = 0; i < states; i++)
+        keys[i] = rng();
+    bench_node dummy_node = {0};
+
+    Hash_table< bench_node > table;
+    long long time_start = currentTimeUs();
+    size_t inserted = 0;
+    for (size_t i = 0; i < states; i++) {
+        bench_node* node_ptr = &dummy_node;
+        inserted += table.insert(keys[i], node_ptr);
+    }
+    long long time_insert = currentTimeUs() - time_start;
+
+    time_start = currentTimeUs();
+    size_t found = 0;
+    for (size_t i = 0; i < states; i++) {
+        bench_node* node_ptr = nullptr;
+        found += table.exist(keys[i], node_ptr);
+    }
+    long long time_exist = currentTimeUs() - time_start;
+
+    time_start = currentTimeUs();
+    size_t duplicates = 0;
+    for (size_t i = 0; i < states; i++) {
+        bench_node* node_ptr = &dummy_node;
+        duplicates += !table.insert(keys[i], node_ptr);
+    }
+    long long time_duplicate = currentTimeUs() - time_start;
+
+    cout << setw(10) << states
+         << setw(14) << fixed << setprecision(1) << (double)states / time_insert << " M/s"
+         << setw(14) << (double)states / time_exist << " M/s"
+         << setw(14) << (double)states / time_duplicate << " M/s"
+         << setw(12) << table.capacity()
+         << "   (" << inserted << " inserted, " << found << " found, " << duplicates << " duplicates)" << endl;
+}
+
+int main(int argc,  char **argv) {
+    cout << setw(10) << "states" << setw(18) << "insert" << setw(18) << "lookup" << setw(18) << "duplicate" << setw(12) << "slots" << endl;
+    bench_states(100000);
+    bench_states(1000000);
+    bench_states(10000000);
+    return 0;
+}
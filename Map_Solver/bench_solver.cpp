@@ -0,0 +1,292 @@
+//
+//  bench_solver.cpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Solve time, expanded nodes and peak memory of the solver over the test maps, compared with a stored baseline.
+//  Build and run with: make bench_check
+//  The baseline belongs to the machine it was measured on; write a new one with: ./bench_solver --save-baseline bench_baseline.csv
+//  HDA scaling: ./bench_solver --solver 3 --threads 1,2,4,8,16 runs every map with each worker count and reports the speedup
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common.cpp"
+#include "Map.hpp"
+#include "Sokoban_features.hpp"
+#include "Batch_solver.hpp"
+
+#define BENCH_DEFAULT_RUNS       7 // measured runs of every map
+#define BENCH_DEFAULT_WARMUP     1 // runs of every map before the measured ones; not reported
+#define BENCH_DEFAULT_THRESHOLD  0.25 // relative growth of the nodes or memory over the baseline that is a regression
+#define BENCH_TIME_THRESHOLD     0.5 // relative growth of the median time that is a regression; wider since the time is noisy
+#define BENCH_MIN_TIME_US        2000 // maps whose baseline median is below this are too noisy for the time gate
+#define BENCH_DEFAULT_BASELINE   "bench_baseline.csv"
+
+using namespace std;
+
+struct run_sample {
+    bool solved = false;
+    int steps = 0;
+    long expanded = 0;
+    long long time_us = 0;
+    long peak_kb = 0; // peak resident set size of the process that solved the map
+};
+
+struct map_stats {
+    string map_file;
+    int solver_type = Astar;
+    int threads = 0; // HDA workers; 0 uses one per core
+    int runs = 0; // measured runs
+    int solved = 0; // measured runs that found a solution
+    long long median_us = 0;
+    long long p95_us = 0;
+    long expanded = 0;
+    double nodes_per_s = 0;
+    long peak_kb = 0;
+};
+
+long long currentTimeUs()
+// Timer function
+{
+    timeval current;
+    gettimeofday(&current, 0);
+    return (long long)current.tv_sec * 1000000L + current.tv_usec;
+}
+
+run_sample run_once(const string& map_file, int solver_type, int max_search, int threads)
+// Solves the map in a child process so its peak memory is measured alone and no run inherits the state of another
+// Only the solve is timed; loading the map and building the distance maps are not. The pattern file is not used
+{
+    run_sample sample;
+    int result_pipe[2];
+    if (pipe(result_pipe) != 0)
+        return sample;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(result_pipe[0]);
+        if (!freopen("/dev/null", "w", stdout)) // the map and solver messages
+            _exit(1);
+        Map bench_map;
+        if (bench_map.load_map_from_file(map_file) and bench_map.create_deadlock_free_map()) {
+            bench_map.create_wavefront_map();
+            bench_map.create_push_distance_map();
+            Sokoban_features feature_tree(&bench_map);
+            feature_tree.set_verbose(false);
+            feature_tree.set_thread_count(threads);
+            long long time_start = currentTimeUs();
+            sample.solved = feature_tree.solve(solver_type, max_search);
+            sample.time_us = currentTimeUs() - time_start;
+            if (sample.solved)
+                sample.steps = feature_tree.get_goal_node_ptr()->depth;
+            sample.expanded = feature_tree.get_closed_list_size();
+        }
+        if (write(result_pipe[1], &sample, sizeof(sample)) != sizeof(sample))
+            _exit(1);
+        _exit(0);
+    }
+    close(result_pipe[1]);
+    if (pid > 0) {
+        if (read(result_pipe[0], &sample, sizeof(sample)) != sizeof(sample))
+            sample = run_sample();
+        int status;
+        rusage usage;
+        if (wait4(pid, &status, 0, &usage) == pid)
+            sample.peak_kb = usage.ru_maxrss; // kilobytes on Linux
+    }
+    close(result_pipe[0]);
+    return sample;
+}
+
+map_stats bench_map(const string& map_file, int solver_type, int max_search, int threads, int runs, int warmup)
+// Runs the map warmup + runs times and reduces the measured runs to median and p95 time
+// The nodes are the same in every run; the peak memory is the largest of the runs
+{
+    map_stats stats;
+    stats.map_file = map_file;
+    stats.solver_type = solver_type;
+    stats.threads = threads;
+    stats.runs = runs;
+    for (int i = 0; i < warmup; i++)
+        run_once(map_file, solver_type, max_search, threads);
+    vector< long long > times;
+    for (int i = 0; i < runs; i++) {
+        run_sample sample = run_once(map_file, solver_type, max_search, threads);
+        stats.solved += sample.solved;
+        stats.expanded = sample.expanded;
+        stats.peak_kb = max(stats.peak_kb, sample.peak_kb);
+        times.push_back(sample.time_us);
+    }
+    sort(times.begin(), times.end());
+    stats.median_us = times[times.size() / 2];
+    stats.p95_us = times[(size_t)ceil(0.95 * times.size()) - 1];
+    if (stats.median_us > 0)
+        stats.nodes_per_s = stats.expanded * 1e6 / stats.median_us;
+    return stats;
+}
+
+vector< map_stats > load_baseline(const string& file_name)
+// Reads a baseline written by save_baseline; an empty list if there is none
+{
+    vector< map_stats > baseline;
+    ifstream baseline_file(file_name);
+    string line;
+    getline(baseline_file, line); // header
+    while (getline(baseline_file, line)) {
+        stringstream line_stream(line);
+        map_stats stats;
+        string field;
+        getline(line_stream, stats.map_file, ',');
+        getline(line_stream, field, ','); stats.solver_type = atoi(field.c_str());
+        getline(line_stream, field, ','); stats.runs = atoi(field.c_str());
+        getline(line_stream, field, ','); stats.solved = atoi(field.c_str());
+        getline(line_stream, field, ','); stats.median_us = atoll(field.c_str());
+        getline(line_stream, field, ','); stats.p95_us = atoll(field.c_str());
+        getline(line_stream, field, ','); stats.expanded = atol(field.c_str());
+        getline(line_stream, field, ','); stats.nodes_per_s = atof(field.c_str());
+        getline(line_stream, field, ','); stats.peak_kb = atol(field.c_str());
+        baseline.push_back(stats);
+    }
+    return baseline;
+}
+
+bool save_baseline(const string& file_name, vector< map_stats > &results)
+// Writes the results as the new baseline
+{
+    ofstream baseline_file(file_name);
+    if (!baseline_file.is_open())
+        return false;
+    baseline_file << "map,solver_type,runs,solved,median_us,p95_us,expanded,nodes_per_s,peak_kb\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        map_stats &stats = results[i];
+        baseline_file << stats.map_file << "," << stats.solver_type << "," << stats.runs << "," << stats.solved << "," << stats.median_us << ","
+                      << stats.p95_us << "," << stats.expanded << "," << fixed << setprecision(0) << stats.nodes_per_s << ","
+                      << stats.peak_kb << "\n";
+    }
+    return baseline_file.good();
+}
+
+string compare_with_baseline(map_stats &stats, vector< map_stats > &baseline, double threshold, double time_threshold)
+// Returns what regressed against the baseline of the map ("" if nothing did, "new" if the map has no baseline)
+{
+    for (size_t i = 0; i < baseline.size(); i++) {
+        map_stats &base = baseline[i];
+        if (base.map_file != stats.map_file or base.solver_type != stats.solver_type)
+            continue;
+        string regressed;
+        if (stats.solved * base.runs < base.solved * stats.runs)
+            regressed += " unsolved";
+        if (stats.expanded > base.expanded * (1 + threshold))
+            regressed += " nodes";
+        if (base.median_us >= BENCH_MIN_TIME_US and stats.median_us > base.median_us * (1 + time_threshold))
+            regressed += " time";
+        if (stats.peak_kb > base.peak_kb * (1 + threshold))
+            regressed += " memory";
+        return regressed;
+    }
+    return "new";
+}
+
+int main(int argc,  char **argv) {
+    // bench_solver [--runs N] [--warmup N] [--solver N] [--threads N[,N...]] [--max-search N] [--threshold X] [--time-threshold X]
+    //              [--baseline file] [--save-baseline file] [maps or directories]
+    int runs = BENCH_DEFAULT_RUNS;
+    int warmup = BENCH_DEFAULT_WARMUP;
+    int solver_type = Astar;
+    int max_search = BATCH_DEFAULT_MAX_SEARCH;
+    double threshold = BENCH_DEFAULT_THRESHOLD;
+    double time_threshold = BENCH_TIME_THRESHOLD;
+    string baseline_file_name = BENCH_DEFAULT_BASELINE;
+    string save_file_name;
+    vector< int > thread_counts(1, 0); // the speedup of every count is relative to the first one
+    Batch_solver suite; // only used to collect the map files
+    bool any_path = false;
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--runs" and i+1 < argc)
+            runs = max(atoi(argv[++i]), 1);
+        else if (argument == "--warmup" and i+1 < argc)
+            warmup = max(atoi(argv[++i]), 0);
+        else if (argument == "--solver" and i+1 < argc)
+            solver_type = atoi(argv[++i]);
+        else if (argument == "--threads" and i+1 < argc) {
+            thread_counts.clear();
+            stringstream count_stream(argv[++i]);
+            string field;
+            while (getline(count_stream, field, ','))
+                thread_counts.push_back(max(atoi(field.c_str()), 0));
+        } else if (argument == "--max-search" and i+1 < argc)
+            max_search = atoi(argv[++i]);
+        else if (argument == "--threshold" and i+1 < argc)
+            threshold = atof(argv[++i]);
+        else if (argument == "--time-threshold" and i+1 < argc)
+            time_threshold = atof(argv[++i]);
+        else if (argument == "--baseline" and i+1 < argc)
+            baseline_file_name = argv[++i];
+        else if (argument == "--save-baseline" and i+1 < argc)
+            save_file_name = argv[++i];
+        else
+            any_path |= suite.add_path(argument);
+    }
+    if (!any_path) { // the default suite; the maps that solve within seconds
+        suite.add_path("tm/nodes_map-size");
+        suite.add_path("tm/box_time");
+        suite.add_path("tm/branching");
+    }
+    vector< string > map_files = suite.get_map_files();
+    vector< map_stats > baseline = load_baseline(baseline_file_name);
+    if (save_file_name.empty() and baseline.empty())
+        cout << "No baseline in " << baseline_file_name << "; nothing is compared" << endl;
+
+    cout << setw(8) << "threads" << setw(8) << "solved" << setw(12) << "median_us" << setw(12) << "p95_us" << setw(12) << "expanded"
+         << setw(14) << "nodes/s" << setw(10) << "peak_kb" << setw(9) << "speedup" << "  " << "status" << "  map" << endl;
+    vector< map_stats > results;
+    int regressions = 0;
+    for (size_t i = 0; i < map_files.size() * thread_counts.size(); i++) {
+        size_t count_id = i % thread_counts.size();
+        results.push_back(bench_map(map_files[i / thread_counts.size()], solver_type, max_search, thread_counts[count_id], runs, warmup));
+        map_stats &stats = results.back();
+        map_stats &first_stats = results[results.size()-1 - count_id]; // the same map with the first worker count
+        double speedup = stats.median_us > 0 ? (double)first_stats.median_us / stats.median_us : 0;
+        string status = "ok";
+        if (save_file_name.empty() and !baseline.empty()) {
+            string regressed = compare_with_baseline(stats, baseline, threshold, time_threshold);
+            if (regressed == "new")
+                status = "new";
+            else if (!regressed.empty()) {
+                status = "REGRESSED:" + regressed;
+                regressions++;
+            }
+        }
+        cout << setw(8) << (stats.threads ? to_string(stats.threads) : "cores") << setw(8) << to_string(stats.solved) + "/" + to_string(runs)
+             << setw(12) << stats.median_us << setw(12) << stats.p95_us << setw(12) << stats.expanded << setw(14) << fixed << setprecision(0)
+             << stats.nodes_per_s << setw(10) << stats.peak_kb << setw(9) << setprecision(2) << speedup << "  " << status << "  " << stats.map_file << endl;
+    }
+
+    if (!save_file_name.empty()) {
+        if (!save_baseline(save_file_name, results)) {
+            cout << "Unable to write " << save_file_name << endl;
+            return 1;
+        }
+        cout << "Baseline saved to " << save_file_name << endl;
+        return 0;
+    }
+    if (regressions) {
+        cout << regressions << " of " << results.size() << " maps regressed against " << baseline_file_name << " (more than "
+             << threshold * 100 << "% nodes or memory, " << time_threshold * 100 << "% time)" << endl;
+        return 1;
+    }
+    return 0;
+}
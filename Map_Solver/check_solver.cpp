@@ -0,0 +1,206 @@
+//
+//  check_solver.cpp
+//  AI1_Sokoban-solver_MM-TL
+//
+//  Regression check of the solvers: every plan is replayed move by move on the map, it has to reach the goal with the
+//  cost the solver reports, and the optimal solvers have to find the known optimal cost.
+//  Build and run with: make check
+//
+//  All files are licenced under the BSD 3-Clause (see LICENSE.md)
+//
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "common.cpp"
+#include "Map.hpp"
+#include "Sokoban_features.hpp"
+
+#define CHECK_MAX_SEARCH   10000000
+#define CHECK_COST_EPSILON 1e-6
+#define CHECK_THREADS      4 // HDA workers; more than one so the messages between the workers are checked as well
+
+using namespace std;
+
+struct check_case {
+    string map_file;
+    int solver_type;
+    double optimal_cost; // the plan has to cost exactly this much; 0 only replays the plan
+    double max_factor; // the plan may cost up to max_factor times optimal_cost instead (WAstar)
+    int optimal_pushes; // the plan has to push the boxes exactly this often (push solvers); 0 does not count the pushes
+};
+
+const check_case check_cases[] = {
+    {"tm/nodes_map-size/simple.txt",   Astar,   32,  1, 0},
+    {"tm/box_time/2box.txt",           Astar,   14,  1, 0},
+    {"tm/box_time/3box.txt",           Astar,   25,  1, 0},
+    {"tm/box_time/4box.txt",           Astar,   35,  1, 0},
+    {"tm/box_time/5box.txt",           Astar,   46,  1, 0},
+    {"tm/branching/2015competition.txt", Astar, 211, 1, 0},
+    {"tm/nodes_map-size/simple.txt",   IDAstar, 32,  1, 0},
+    {"tm/box_time/2box.txt",           IDAstar, 14,  1, 0},
+    {"tm/box_time/4box.txt",           IDAstar, 35,  1, 0},
+    {"tm/nodes_map-size/simple.txt",   SMAstar, 32,  1, 0},
+    {"tm/box_time/2box.txt",           SMAstar, 14,  1, 0},
+    {"tm/box_time/5box.txt",           SMAstar, 46,  1, 0},
+    {"tm/nodes_map-size/simple.txt",   HDA,     32,  1, 0},
+    {"tm/box_time/2box.txt",           HDA,     14,  1, 0},
+    {"tm/box_time/5box.txt",           HDA,     46,  1, 0},
+    {"tm/nodes_map-size/simple.txt",   WAstar,  32,  ARA_DEFAULT_WEIGHT, 0},
+    {"tm/box_time/4box.txt",           WAstar,  35,  ARA_DEFAULT_WEIGHT, 0},
+    {"tm/box_time/5box.txt",           WAstar,  46,  ARA_DEFAULT_WEIGHT, 0},
+    {"tm/branching/2015competition.txt", WAstar, 211, ARA_DEFAULT_WEIGHT, 0},
+    {"tm/nodes_map-size/simple.txt",   ARAstar, 32,  1, 0},
+    {"tm/box_time/4box.txt",           ARAstar, 35,  1, 0},
+    {"tm/box_time/5box.txt",           ARAstar, 46,  1, 0},
+    {"tm/branching/2015competition.txt", ARAstar, 211, 1, 0},
+    {"tm/nodes_map-size/simple.txt",   Push,    0,   1, 6},
+    {"tm/box_time/4box.txt",           Push,    0,   1, 8},
+    {"tm/branching/2015competition.txt", Push,  0,   1, 40},
+    {"tm/nodes_map-size/simple.txt",   BiPush,  0,   1, 6},
+    {"tm/box_time/2box.txt",           BiPush,  0,   1, 4},
+    {"tm/box_time/3box.txt",           BiPush,  0,   1, 6},
+    {"tm/box_time/4box.txt",           BiPush,  0,   1, 8},
+    {"tm/box_time/5box.txt",           BiPush,  0,   1, 10},
+    {"tm/branching/2015competition.txt", BiPush, 0,  1, 40},
+};
+
+int side_of(int in_dir)
+// Returns the side (0 north, 1 east, 2 south, 3 west) of a worker_dir
+{
+    return in_dir - 1;
+}
+
+string replay_plan(Map &check_map, Sokoban_features &feature_tree, double &replayed_cost, int &replayed_pushes)
+// Replays the plan from the root to the goal node; returns why it is invalid or "" if every move is legal and the goal is reached
+// replayed_cost is the sum of the move costs of the cost defines and replayed_pushes the number of moves that push a box
+{
+    const int step_x[4] = {0, 1, 0, -1};
+    const int step_y[4] = {-1, 0, 1, 0};
+    vector< Sokoban_features::feature_node* > chain;
+    for (Sokoban_features::feature_node* tmp_node = feature_tree.get_goal_node_ptr(); tmp_node != nullptr; tmp_node = tmp_node->parent)
+        chain.push_back(tmp_node);
+    reverse(chain.begin(), chain.end());
+    replayed_cost = 0;
+    replayed_pushes = 0;
+
+    point2D start_worker = check_map.get_worker();
+    point2D root_worker = feature_tree.get_worker_pos(chain[0]);
+    if (root_worker.x != start_worker.x or root_worker.y != start_worker.y)
+        return "the plan does not start at the worker";
+    for (size_t i = 1; i < chain.size(); i++) {
+        point2D worker_from = feature_tree.get_worker_pos(chain[i-1]);
+        point2D worker_to = feature_tree.get_worker_pos(chain[i]);
+        vector< point2D > boxes_from = feature_tree.get_boxes(chain[i-1]);
+        vector< point2D > boxes_to = feature_tree.get_boxes(chain[i]);
+        int side_from = side_of(chain[i-1]->worker_dir());
+        int side_to = side_of(chain[i]->worker_dir());
+        string step_name = "move " + to_string(i) + ": ";
+        auto box_index = [](vector< point2D > &in_boxes, int in_x, int in_y) {
+            for (size_t j = 0; j < in_boxes.size(); j++)
+                if (in_boxes[j].x == in_x and in_boxes[j].y == in_y)
+                    return (int)j;
+            return -1;
+        };
+        if (side_from != side_to) {
+            if (worker_from.x != worker_to.x or worker_from.y != worker_to.y or (side_from - side_to + 4) % 2 != 1)
+                return step_name + "a turn has to be 90 degrees on the spot";
+            for (size_t j = 0; j < boxes_to.size(); j++)
+                if (box_index(boxes_from, boxes_to[j].x, boxes_to[j].y) < 0)
+                    return step_name + "a turn moved a box";
+            replayed_cost += (side_to == (side_from + 1) % 4) ? right_cost : left_cost;
+            continue;
+        }
+        int dx = worker_to.x - worker_from.x;
+        int dy = worker_to.y - worker_from.y;
+        if (check_map.map_point_type(worker_to, worker) == obstacle)
+            return step_name + "the worker walks into a wall";
+        if (dx == step_x[side_from] and dy == step_y[side_from]) {
+            int pushed = box_index(boxes_from, worker_to.x, worker_to.y);
+            if (pushed < 0) {
+                replayed_cost += forward_cost;
+            } else {
+                point2D box_to;
+                box_to.x = worker_to.x + dx;
+                box_to.y = worker_to.y + dy;
+                if (check_map.map_point_type(box_to, box) == obstacle or box_index(boxes_from, box_to.x, box_to.y) >= 0)
+                    return step_name + "the box is pushed into a wall or a box";
+                boxes_from[pushed] = box_to;
+                replayed_cost += approach_cost;
+                replayed_pushes++;
+            }
+        } else if (dx == -step_x[side_from] and dy == -step_y[side_from]) {
+            if (box_index(boxes_from, worker_to.x, worker_to.y) >= 0)
+                return step_name + "the worker backs into a box";
+            replayed_cost += backward_cost;
+        } else
+            return step_name + "the worker jumps";
+        for (size_t j = 0; j < boxes_to.size(); j++)
+            if (box_index(boxes_from, boxes_to[j].x, boxes_to[j].y) < 0)
+                return step_name + "the boxes do not follow the move";
+    }
+    if (!feature_tree.goal_node(chain.back()))
+        return "the plan does not end with every box on a goal";
+    return "";
+}
+
+string run_case(const check_case &in_case, double &plan_cost, int &plan_pushes)
+// Solves the map of the case and returns what is wrong with the plan ("" if nothing)
+{
+    Map check_map;
+    if (!check_map.load_map_from_file(in_case.map_file) or !check_map.create_deadlock_free_map())
+        return "the map cannot be loaded";
+    check_map.create_wavefront_map();
+    check_map.create_push_distance_map();
+    Sokoban_features feature_tree(&check_map);
+    feature_tree.set_verbose(false);
+    feature_tree.set_thread_count(CHECK_THREADS);
+    if (!feature_tree.solve(in_case.solver_type, CHECK_MAX_SEARCH) or feature_tree.get_goal_node_ptr() == nullptr)
+        return "no plan";
+    plan_cost = feature_tree.get_goal_node_ptr()->cost_to_node;
+    double replayed_cost = 0;
+    string invalid = replay_plan(check_map, feature_tree, replayed_cost, plan_pushes);
+    if (!invalid.empty())
+        return invalid;
+    if (fabs(replayed_cost - plan_cost) > CHECK_COST_EPSILON)
+        return "reported cost " + to_string(plan_cost) + " but the plan costs " + to_string(replayed_cost);
+    if (in_case.optimal_cost > 0 and plan_cost > in_case.optimal_cost * in_case.max_factor + CHECK_COST_EPSILON)
+        return "cost " + to_string(plan_cost) + " above the bound " + to_string(in_case.optimal_cost * in_case.max_factor);
+    if (in_case.optimal_cost > 0 and plan_cost < in_case.optimal_cost - CHECK_COST_EPSILON)
+        return "cost " + to_string(plan_cost) + " below the optimum " + to_string(in_case.optimal_cost);
+    if (in_case.optimal_pushes > 0 and plan_pushes != in_case.optimal_pushes)
+        return to_string(plan_pushes) + " pushes instead of the optimal " + to_string(in_case.optimal_pushes);
+    return "";
+}
+
+int main(int argc,  char **argv) {
+    // check_solver [solver]; without a solver every case is run
+    int only_solver = argc > 1 ? atoi(argv[1]) : -1;
+    int failures = 0;
+    int checked = 0;
+    cout << setw(8) << "solver" << setw(10) << "cost" << setw(8) << "pushes" << "  " << "status" << "  map" << endl;
+    for (const check_case &tmp_case : check_cases) {
+        if (only_solver >= 0 and tmp_case.solver_type != only_solver)
+            continue;
+        double plan_cost = 0;
+        int plan_pushes = 0;
+        string failure = run_case(tmp_case, plan_cost, plan_pushes);
+        checked++;
+        if (!failure.empty())
+            failures++;
+        cout << setw(8) << tmp_case.solver_type << setw(10) << plan_cost << setw(8) << plan_pushes << "  " << (failure.empty() ? "ok" : "FAILED: " + failure)
+             << "  " << tmp_case.map_file << endl;
+    }
+    if (failures) {
+        cout << failures << " of " << checked << " checks failed" << endl;
+        return 1;
+    }
+    cout << "All " << checked << " checks passed" << endl;
+    return 0;
+}
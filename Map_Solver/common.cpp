@@ -9,6 +9,13 @@
 
 #define BF      0 // Breadth-first
 #define Astar   1 // A*
+#define Push    2 // A* over box pushes; the steps between the pushes are filled in afterwards
+#define HDA     3 // A* on all cores; every state is searched by the thread owning its hash (hash-distributed A*)
+#define BiPush  4 // A* over pushes from the start and over pulls from the solved configuration until they meet
+#define IDAstar 5 // Iterative deepening A*; keeps the current path and a fixed size transposition table only
+#define SMAstar 6 // A* within a memory budget; forgets the worst open leaves when the budget is used up
+#define WAstar  7 // Weighted A*; f = g + w * h gives a solution within w times the optimal cost fast
+#define ARAstar 8 // Anytime repairing A*; weighted A* that lowers the weight and improves the solution while time remains
 
 #define F       1 // Forward move
 #define B       2 // Backward move
@@ -21,3 +28,5 @@ struct point2D {
   int x;
   int y;
 } ;
+
+typedef unsigned short cell_t; // cell index in the map, y * width + x
@@ -16,37 +16,38 @@
 #include "common.cpp"
 #include "Map.hpp"
 #include "Sokoban_features.hpp"
+#include "Batch_solver.hpp"
 
 using namespace std;
 
 int determine_robot_move(Sokoban_features::feature_node* current_ptr, Sokoban_features::feature_node* parent_ptr, Sokoban_features &tree) {
-    if (current_ptr->worker_dir == parent_ptr->worker_dir) {
-        if (current_ptr->worker_dir == NORTH) {
-            if (tree.point_type(parent_ptr, current_ptr->worker_pos.x, current_ptr->worker_pos.y+1, worker) == worker) {
+    if (current_ptr->worker_dir() == parent_ptr->worker_dir()) {
+        if (current_ptr->worker_dir() == NORTH) {
+            if (tree.point_type(parent_ptr, tree.get_worker_pos(current_ptr).x, tree.get_worker_pos(current_ptr).y+1, worker) == worker) {
                 // Forwards move
                 return F;
             } else {
                 // Backwards move
                 return B;
             }
-        } else if (current_ptr->worker_dir == EAST) {
-            if (tree.point_type(parent_ptr, current_ptr->worker_pos.x-1, current_ptr->worker_pos.y, worker) == worker) {
+        } else if (current_ptr->worker_dir() == EAST) {
+            if (tree.point_type(parent_ptr, tree.get_worker_pos(current_ptr).x-1, tree.get_worker_pos(current_ptr).y, worker) == worker) {
                 // Forwards move
                 return F;
             } else {
                 // Backwards move
                 return B;
             }
-        } else if (current_ptr->worker_dir == SOUTH) {
-            if (tree.point_type(parent_ptr, current_ptr->worker_pos.x, current_ptr->worker_pos.y-1, worker) == worker) {
+        } else if (current_ptr->worker_dir() == SOUTH) {
+            if (tree.point_type(parent_ptr, tree.get_worker_pos(current_ptr).x, tree.get_worker_pos(current_ptr).y-1, worker) == worker) {
                 // Forwards move
                 return F;
             } else {
                 // Backwards move
                 return B;
             }
-        } else if (current_ptr->worker_dir == WEST) {
-            if (tree.point_type(parent_ptr, current_ptr->worker_pos.x+1, current_ptr->worker_pos.y, worker) == worker) {
+        } else if (current_ptr->worker_dir() == WEST) {
+            if (tree.point_type(parent_ptr, tree.get_worker_pos(current_ptr).x+1, tree.get_worker_pos(current_ptr).y, worker) == worker) {
                 // Forwards move
                 return F;
             } else {
@@ -56,10 +57,10 @@ int determine_robot_move(Sokoban_features::feature_node* current_ptr, Sokoban_fe
         }
     } else {
         // A turn is detected
-        if (   (current_ptr->worker_dir == NORTH and parent_ptr->worker_dir == EAST)
-            or (current_ptr->worker_dir == EAST and parent_ptr->worker_dir == SOUTH)
-            or (current_ptr->worker_dir == SOUTH and parent_ptr->worker_dir == WEST)
-            or (current_ptr->worker_dir == WEST and parent_ptr->worker_dir == NORTH)    )
+        if (   (current_ptr->worker_dir() == NORTH and parent_ptr->worker_dir() == EAST)
+            or (current_ptr->worker_dir() == EAST and parent_ptr->worker_dir() == SOUTH)
+            or (current_ptr->worker_dir() == SOUTH and parent_ptr->worker_dir() == WEST)
+            or (current_ptr->worker_dir() == WEST and parent_ptr->worker_dir() == NORTH)    )
         {
             return L; // CCW
         }
@@ -72,23 +73,23 @@ int determine_robot_move(Sokoban_features::feature_node* current_ptr, Sokoban_fe
 }
 
 bool box_inFrontOf_robot (Sokoban_features::feature_node* current_ptr, Sokoban_features &tree) {
-    if (current_ptr->worker_dir == NORTH) {
-        if (tree.point_type(current_ptr, current_ptr->worker_pos.x, current_ptr->worker_pos.y-1, worker)==box)
+    if (current_ptr->worker_dir() == NORTH) {
+        if (tree.point_type(current_ptr, tree.get_worker_pos(current_ptr).x, tree.get_worker_pos(current_ptr).y-1, worker)==box)
             return true;
         else
             return false;
-    } else if (current_ptr->worker_dir == EAST) {
-        if (tree.point_type(current_ptr, current_ptr->worker_pos.x+1, current_ptr->worker_pos.y, worker)==box)
+    } else if (current_ptr->worker_dir() == EAST) {
+        if (tree.point_type(current_ptr, tree.get_worker_pos(current_ptr).x+1, tree.get_worker_pos(current_ptr).y, worker)==box)
             return true;
         else
             return false;
-    } else if (current_ptr->worker_dir == SOUTH) {
-        if (tree.point_type(current_ptr, current_ptr->worker_pos.x, current_ptr->worker_pos.y+1, worker)==box)
+    } else if (current_ptr->worker_dir() == SOUTH) {
+        if (tree.point_type(current_ptr, tree.get_worker_pos(current_ptr).x, tree.get_worker_pos(current_ptr).y+1, worker)==box)
             return true;
         else
             return false;
-    } else if (current_ptr->worker_dir == WEST) {
-        if (tree.point_type(current_ptr, current_ptr->worker_pos.x-1, current_ptr->worker_pos.y, worker)==box)
+    } else if (current_ptr->worker_dir() == WEST) {
+        if (tree.point_type(current_ptr, tree.get_worker_pos(current_ptr).x-1, tree.get_worker_pos(current_ptr).y, worker)==box)
             return true;
         else
             return false;
@@ -212,9 +213,54 @@ void make_robot_commands(Sokoban_features::feature_node* solution_ptr, Sokoban_f
     myfile.close();
 }
 
+void print_memory(Sokoban_features &tree) {
+    // Prints the high-water mark of the search structures and the peak resident set size of the process
+    Sokoban_features::memory_usage memory_peak = tree.get_memory_peak();
+    tree.print_info("Memory peak " + to_string(memory_peak.total() >> 10) + " kB (nodes " + to_string(memory_peak.nodes >> 10)
+                    + ", children " + to_string(memory_peak.children >> 10) + ", open list " + to_string(memory_peak.open_list >> 10)
+                    + ", closed list " + to_string(memory_peak.closed_list >> 10) + ", hash table " + to_string(memory_peak.hash_table >> 10)
+                    + " kB); process peak " + to_string(Sokoban_features::get_peak_rss() >> 10) + " kB");
+}
+
+int run_batch(int argc, char **argv) {
+    // Batch mode: Map_Solver --batch [--solver N] [--runs N] [--threads N] [--max-search N] [--output file.csv] <maps or directories>
+    Batch_solver batch;
+    string output_file_name = "batch_results.csv";
+    bool any_path = false;
+    for (int i = 2; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--solver" and i+1 < argc)
+            batch.set_solver(atoi(argv[++i]));
+        else if (argument == "--runs" and i+1 < argc)
+            batch.set_runs(atoi(argv[++i]));
+        else if (argument == "--threads" and i+1 < argc)
+            batch.set_threads(atoi(argv[++i]));
+        else if (argument == "--max-search" and i+1 < argc)
+            batch.set_max_search(atoi(argv[++i]));
+        else if (argument == "--output" and i+1 < argc)
+            output_file_name = argv[++i];
+        else
+            any_path |= batch.add_path(argument);
+    }
+    if (!any_path or !batch.run()) {
+        cout << "Please provide map files or directories with maps and try again!" << endl;
+        return 1;
+    }
+    batch.print_results();
+    if (!batch.save_results(output_file_name)) {
+        cout << "Unable to write " << output_file_name << endl;
+        return 1;
+    }
+    cout << "[BATCH] Results saved to " << output_file_name << endl;
+    return 0;
+}
+
 int main(int argc,  char **argv) {
-    if (argc >= 2) { // Accept only one file
+    if (argc >= 2 and string(argv[1]) == "--batch")
+        return run_batch(argc, argv);
+    if (argc >= 2) { // Accept only one file; Map_Solver <map> [--patterns]
         string map_file_name = argv[1]; //filename
+        bool use_patterns = argc >= 3 and string(argv[2]) == "--patterns"; // load and save the deadlock patterns of the map
         Map initial_map;
         Map* initial_map_ptr = &initial_map;
         if (initial_map.load_map_from_file(map_file_name)) {
@@ -234,11 +280,13 @@ int main(int argc,  char **argv) {
                  initial_map.print_map_simple(worker);
                  initial_map.print_map_simple(box);
                  Sokoban_features feature_tree(initial_map_ptr);
+                 feature_tree.set_pattern_file(use_patterns);
                  feature_tree.print_info("Starting search");
                  long long time_start = feature_tree.currentTimeUs();
                  long long time_end;
                  int solver_type = Astar;
                  initial_map.create_wavefront_map(); // Generate wavefront maps
+                 initial_map.create_push_distance_map(); // Generate push distance maps used by the heuristic
                  if (feature_tree.solve(solver_type, 10000000)) {  // Solve using Breadth-first searching
                      time_end = feature_tree.currentTimeUs();
                      cout << "Start time was " << time_start << " and end time was " << time_end << " and diff is "<< time_end-time_start << endl;
@@ -247,6 +295,7 @@ int main(int argc,  char **argv) {
                      feature_tree.print_info("Solved");
                      feature_tree.print_info("Nodes visited "+to_string(feature_tree.get_closed_list_size()));
                      feature_tree.print_info("Nodes not visited "+to_string(feature_tree.get_open_list_size()));
+                     print_memory(feature_tree);
                      //make_robot_commands(feature_tree.get_goal_node_ptr(), feature_tree);
                      cout << endl;
 
@@ -261,11 +310,14 @@ int main(int argc,  char **argv) {
                      found_solution = false;
                      feature_tree.print_info("No solution was found using the selected search algorithm");
                      feature_tree.print_info("Visited "+to_string(feature_tree.get_closed_list_size())+" nodes");
+                     print_memory(feature_tree);
                  }
+                 Sokoban_features::memory_usage memory_peak = feature_tree.get_memory_peak();
                  ofstream timing_data;
                  timing_data.open ("timing_data.csv",fstream::app|fstream::out);
-                 //timing_data << "t_start,t_end,t_diff,closed_list,open_list,solver_type,solved,steps\n"; // Only used for saving the file the first time, otherwise it just appends
-                 timing_data << setprecision(8) << time_start << "," << time_end << "," << time_end-time_start << setprecision(0) << "," << feature_tree.get_closed_list_size() << "," << feature_tree.get_open_list_size() << "," << solver_type << "," << found_solution << "," << solution_steps << "\n";
+                 //timing_data << "t_start,t_end,t_diff,closed_list,open_list,solver_type,solved,steps,mem_nodes,mem_children,mem_open_list,mem_closed_list,mem_hash_table,mem_peak,peak_rss\n"; // Only used for saving the file the first time, otherwise it just appends
+                 timing_data << setprecision(8) << time_start << "," << time_end << "," << time_end-time_start << setprecision(0) << "," << feature_tree.get_closed_list_size() << "," << feature_tree.get_open_list_size() << "," << solver_type << "," << found_solution << "," << solution_steps
+                             << "," << memory_peak.nodes << "," << memory_peak.children << "," << memory_peak.open_list << "," << memory_peak.closed_list << "," << memory_peak.hash_table << "," << memory_peak.total() << "," << Sokoban_features::get_peak_rss() << "\n";
                  // remove set precision!!! no effect here!
              }
         }